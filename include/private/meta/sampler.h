@@ -88,6 +88,14 @@ namespace lsp
             static constexpr float FADEOUT_DFL                  = 10.0f;        // Fade-out default (ms)
             static constexpr float FADEOUT_STEP                 = 0.025f;       // Fade-out step (ms)
 
+            static constexpr float RENDER_SETTLE_MIN            = 0.0f;         // Minimum time for parameters to settle before render (ms)
+            static constexpr float RENDER_SETTLE_MAX            = 1000.0f;      // Maximum time for parameters to settle before render (ms)
+            static constexpr float RENDER_SETTLE_DFL            = 40.0f;        // Default time for parameters to settle before render (ms)
+            static constexpr float RENDER_INTERVAL_MIN          = 0.0f;         // Minimum interval between renders of the same file (ms)
+            static constexpr float RENDER_INTERVAL_MAX          = 1000.0f;      // Maximum interval between renders of the same file (ms)
+            static constexpr float RENDER_INTERVAL_DFL          = 100.0f;       // Default interval between renders of the same file (ms)
+            static constexpr size_t WORKERS_MAX                 = 4;            // Maximum number of worker threads of the plugin
+
             static constexpr size_t MESH_SIZE                   = 640;          // Maximum mesh size
             static constexpr size_t TRACKS_MAX                  = 2;            // Maximum tracks per mesh/sample
             static constexpr float ACTIVITY_LIGHTING            = 0.1f;         // Activity lighting (seconds)
@@ -108,6 +116,11 @@ namespace lsp
             static constexpr float DYNA_MAX                     = 100.0f;       // Maximum dynamics
 
             static constexpr size_t PLAYBACKS_MAX               = 8192;         // Maximum number of simultaneously playing samples
+            static constexpr size_t EVENTS_MAX                  = 1024;         // Maximum number of scheduled trigger events per instrument
+            static constexpr size_t VOICES_MAX                  = 256;          // Maximum polyphony of the instrument
+            static constexpr size_t TOTAL_VOICES_MAX            = 1024;         // Maximum polyphony of the plugin
+            static constexpr float STEAL_FADEOUT                = 5.0f;         // Fade-out of the stolen voice (ms)
+            static constexpr size_t KEY_RANGE_MAX               = 12;           // Maximum key range of the instrument around its note (semitones)
             static constexpr size_t SAMPLE_FILES                = 8;            // Number of sample files
             static constexpr size_t BUFFER_SIZE                 = 1024;         // Size of temporary buffer
 
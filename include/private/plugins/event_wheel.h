@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_PLUGINS_EVENT_WHEEL_H_
+#define PRIVATE_PLUGINS_EVENT_WHEEL_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        /**
+         * Scheduled trigger event
+         */
+        typedef struct trigger_event_t
+        {
+            trigger_event_t    *pNext;          // Next event in the slot or in the free list
+            wsize_t             nStart;         // Start time of the playback in samples
+            wsize_t             nStop;          // Time of the playback stop, EVENT_NEVER if not stopped
+            wsize_t             nCancel;        // Time of the playback cancel, EVENT_NEVER if not cancelled
+            size_t              nFile;          // Index of the file to play
+            ssize_t             nKey;           // Key of the playback relative to the note of the instrument
+            float               fGain;          // Gain of the playback
+        } trigger_event_t;
+
+        /**
+         * Hashed timer wheel of the trigger events scheduled for the future. Events are stored
+         * in the preallocated pool and are linked into the slots of the wheel by the start time,
+         * so the fetch of the events that start in the current block looks only into the slots
+         * that cover the block. Events scheduled beyond the span of the wheel stay in the slot
+         * until their start time is reached. The wheel is not thread safe and should be accessed
+         * only by the audio thread.
+         */
+        class event_wheel
+        {
+            public:
+                static constexpr wsize_t EVENT_NEVER    = wsize_t(-1);
+
+            private:
+                static constexpr size_t SLOT_SHIFT      = 10;
+                static constexpr size_t SLOTS           = 64;
+
+            private:
+                trigger_event_t        *vSlots[SLOTS];  // Slots of the wheel
+                trigger_event_t        *pFree;          // List of free events
+                trigger_event_t        *vEvents;        // Pool of events
+                size_t                  nCapacity;      // Capacity of the pool
+                size_t                  nPending;       // Number of scheduled events
+
+            protected:
+                inline void             free_event(trigger_event_t *ev);
+
+            public:
+                explicit event_wheel();
+                event_wheel(const event_wheel &) = delete;
+                event_wheel(event_wheel &&) = delete;
+                ~event_wheel();
+
+                event_wheel & operator = (const event_wheel &) = delete;
+                event_wheel & operator = (event_wheel &&) = delete;
+
+            public:
+                /**
+                 * Initialize the wheel
+                 *
+                 * @param capacity maximum number of scheduled events
+                 * @return true on success
+                 */
+                bool                    init(size_t capacity);
+
+                /**
+                 * Destroy the wheel
+                 */
+                void                    destroy();
+
+                /**
+                 * Drop all scheduled events
+                 */
+                void                    clear();
+
+                /**
+                 * Get number of scheduled events
+                 *
+                 * @return number of scheduled events
+                 */
+                inline size_t           pending() const         { return nPending;      }
+
+                /**
+                 * Schedule the trigger event
+                 *
+                 * @param start start time of the playback in samples
+                 * @param file index of the file to play
+                 * @param key key of the playback relative to the note of the instrument
+                 * @param gain gain of the playback
+                 * @return true if the event has been scheduled, false if the pool is exhausted
+                 */
+                bool                    schedule(wsize_t start, size_t file, ssize_t key, float gain);
+
+                /**
+                 * Fetch the event that starts before the specified time and remove it from the wheel
+                 *
+                 * @param ev pointer to store the event
+                 * @param from start of the processed block in samples, all events before this time should be already fetched
+                 * @param to end of the processed block in samples
+                 * @return true if the event has been fetched
+                 */
+                bool                    fetch(trigger_event_t *ev, wsize_t from, wsize_t to);
+
+                /**
+                 * Stop the playbacks of the scheduled events of the file played at the key
+                 *
+                 * @param time time of the stop in samples
+                 * @param file index of the file
+                 * @param key key of the playback relative to the note of the instrument
+                 */
+                void                    stop(wsize_t time, size_t file, ssize_t key);
+
+                /**
+                 * Cancel the playbacks of all scheduled events, events that start after
+                 * the cancel are dropped
+                 *
+                 * @param time time of the cancel in samples
+                 */
+                void                    cancel(wsize_t time);
+
+                /**
+                 * Dump the state of the wheel
+                 *
+                 * @param v state dumper
+                 */
+                void                    dump(dspu::IStateDumper *v) const;
+        };
+
+    } /* namespace plugins */
+} /* namespace lsp */
+
+#endif /* PRIVATE_PLUGINS_EVENT_WHEEL_H_ */
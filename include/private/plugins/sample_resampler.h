@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_PLUGINS_SAMPLE_RESAMPLER_H_
+#define PRIVATE_PLUGINS_SAMPLE_RESAMPLER_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+
+#include <private/plugins/scratch_arena.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        /**
+         * Quality of the polyphase resampler
+         */
+        enum resample_quality_t
+        {
+            RESAMPLE_DRAFT,
+            RESAMPLE_STANDARD,
+            RESAMPLE_MASTERING,
+            RESAMPLE_DFL = RESAMPLE_STANDARD
+        };
+
+        /**
+         * Fast resampling of samples using interpolating readers. Used for pitch shifting
+         * of samples when rendering, as an alternative to the convolution-based resampling
+         * of the sample which is much more expensive for long samples.
+         */
+        class sample_resampler
+        {
+            public:
+                sample_resampler() = delete;
+                sample_resampler(const sample_resampler &) = delete;
+                sample_resampler(sample_resampler &&) = delete;
+
+                sample_resampler & operator = (const sample_resampler &) = delete;
+                sample_resampler & operator = (sample_resampler &&) = delete;
+
+            public:
+                /**
+                 * Check that the sample can be resampled with cubic interpolation without
+                 * aliasing: the interpolating reader does not perform any low-pass filtering,
+                 * so only upsampling is supported
+                 *
+                 * @param src source sample
+                 * @param sample_rate target sample rate
+                 * @return true if cubic interpolation is applicable
+                 */
+                static bool             cubic_supported(const dspu::Sample *src, size_t sample_rate);
+
+                /**
+                 * Read the region of the resampled channel data using cubic (Catmull-Rom) interpolation
+                 *
+                 * @param dst destination buffer to store count samples
+                 * @param src source channel data
+                 * @param length length of the source channel data
+                 * @param src_rate sample rate of the source data
+                 * @param dst_rate sample rate of the destination data
+                 * @param offset offset of the region in the resampled data
+                 * @param count number of samples to read
+                 */
+                static void             cubic_read(float *dst, const float *src, size_t length,
+                                            size_t src_rate, size_t dst_rate, size_t offset, size_t count);
+        };
+
+        /**
+         * Polyphase resampler with the windowed sinc kernel. The kernel is computed once for
+         * the pair of sample rates and stored as the table of phases, each phase is aligned
+         * and padded to the SIMD register size, so every output sample is computed as two
+         * dot products of the source data and the adjacent phases of the kernel.
+         */
+        class polyphase_resampler
+        {
+            private:
+                float              *vKernel;            // Table of kernel phases
+                size_t              nTaps;              // Number of taps per phase, padded
+                size_t              nPhases;            // Number of phases
+                size_t              nSrcRate;           // Source sample rate
+                size_t              nDstRate;           // Destination sample rate
+                size_t              nQuality;           // Quality of the kernel
+                uint8_t            *pData;              // Allocated data
+
+            public:
+                explicit polyphase_resampler();
+                polyphase_resampler(const polyphase_resampler &) = delete;
+                polyphase_resampler(polyphase_resampler &&) = delete;
+                ~polyphase_resampler();
+
+                polyphase_resampler & operator = (const polyphase_resampler &) = delete;
+                polyphase_resampler & operator = (polyphase_resampler &&) = delete;
+
+            public:
+                /**
+                 * Compute the kernel for the pair of sample rates
+                 *
+                 * @param src_rate source sample rate
+                 * @param dst_rate destination sample rate
+                 * @param quality quality of the kernel, see resample_quality_t
+                 * @param scratch scratch arena to allocate the kernel, NULL to allocate on the heap
+                 * @return status of operation
+                 */
+                status_t                init(size_t src_rate, size_t dst_rate, size_t quality, scratch_arena *scratch = NULL);
+
+                /**
+                 * Destroy the kernel
+                 */
+                void                    destroy();
+
+                /**
+                 * Get the length of the resampled data
+                 *
+                 * @param length length of the source data
+                 * @return length of the resampled data
+                 */
+                size_t                  resampled_length(size_t length) const;
+
+                /**
+                 * Read the region of the resampled channel data
+                 *
+                 * @param dst destination buffer to store count samples
+                 * @param src source channel data
+                 * @param length length of the source channel data
+                 * @param offset offset of the region in the resampled data
+                 * @param count number of samples to read
+                 */
+                void                    process(float *dst, const float *src, size_t length, size_t offset, size_t count) const;
+
+                /**
+                 * Resample all channels of the sample
+                 *
+                 * @param s sample to resample
+                 * @return status of operation
+                 */
+                status_t                resample(dspu::Sample *s) const;
+
+                /**
+                 * Dump the state of the resampler
+                 *
+                 * @param v state dumper
+                 */
+                void                    dump(dspu::IStateDumper *v) const;
+
+            public:
+                inline size_t           taps() const        { return nTaps;     }
+                inline size_t           phases() const      { return nPhases;   }
+                inline size_t           quality() const     { return nQuality;  }
+                inline size_t           src_rate() const    { return nSrcRate;  }
+                inline size_t           dst_rate() const    { return nDstRate;  }
+        };
+
+    } /* namespace plugins */
+} /* namespace lsp */
+
+#endif /* PRIVATE_PLUGINS_SAMPLE_RESAMPLER_H_ */
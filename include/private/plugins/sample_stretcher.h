@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_PLUGINS_SAMPLE_STRETCHER_H_
+#define PRIVATE_PLUGINS_SAMPLE_STRETCHER_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+
+#include <private/plugins/sample_resampler.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        /**
+         * Time stretch engine
+         */
+        enum stretch_engine_t
+        {
+            STRETCH_CLASSIC,
+            STRETCH_WSOLA_FAST,
+            STRETCH_WSOLA,
+            STRETCH_DFL = STRETCH_CLASSIC
+        };
+
+        /**
+         * Time stretching of samples using the waveform similarity overlap-add (WSOLA) method.
+         * Each next frame of the output is taken from the source data near the expected position,
+         * the exact position is chosen by the maximum of the normalized cross-correlation
+         * between the candidate frame and the already produced output, so the overlapping
+         * frames are added in phase.
+         */
+        class sample_stretcher
+        {
+            public:
+                sample_stretcher() = delete;
+                sample_stretcher(const sample_stretcher &) = delete;
+                sample_stretcher(sample_stretcher &&) = delete;
+
+                sample_stretcher & operator = (const sample_stretcher &) = delete;
+                sample_stretcher & operator = (sample_stretcher &&) = delete;
+
+            public:
+                /**
+                 * Check that the data can be stretched by the engine
+                 *
+                 * @param engine stretch engine, see stretch_engine_t
+                 * @param sample_rate sample rate of the data
+                 * @param src_length length of the source data
+                 * @param dst_length length of the stretched data
+                 * @return true if the data can be stretched by the engine
+                 */
+                static bool             supported(size_t engine, size_t sample_rate, size_t src_length, size_t dst_length);
+
+                /**
+                 * Stretch the region of the sample
+                 *
+                 * @param s sample to stretch
+                 * @param engine stretch engine, see stretch_engine_t
+                 * @param length the new length of the region
+                 * @param start start of the region
+                 * @param end end of the region
+                 * @param scratch scratch arena to allocate temporary buffers, NULL to allocate on the heap
+                 * @return status of operation, STATUS_UNSUPPORTED if the region can not be stretched
+                 *   by the engine and the classic stretch should be used instead
+                 */
+                static status_t         stretch(dspu::Sample *s, size_t engine, size_t length, size_t start, size_t end,
+                                            scratch_arena *scratch = NULL);
+
+                /**
+                 * Change the pitch of the sample and stretch it to the specified length in one pass:
+                 * frames of the stretch engine are read from the source data through the resampler,
+                 * so the resampled data is never stored completely
+                 *
+                 * @param s sample to process
+                 * @param engine stretch engine, see stretch_engine_t
+                 * @param r resampler which changes the pitch of the sample
+                 * @param length the length of the result
+                 * @param scratch scratch arena to allocate temporary buffers, NULL to allocate on the heap
+                 * @return status of operation, STATUS_UNSUPPORTED if the sample can not be processed
+                 *   by the engine
+                 */
+                static status_t         pitch_shift(dspu::Sample *s, size_t engine, const polyphase_resampler *r, size_t length,
+                                            scratch_arena *scratch = NULL);
+        };
+
+    } /* namespace plugins */
+} /* namespace lsp */
+
+#endif /* PRIVATE_PLUGINS_SAMPLE_STRETCHER_H_ */
@@ -30,6 +30,7 @@
 
 #include <private/meta/sampler.h>
 #include <private/plugins/sampler_kernel.h>
+#include <private/plugins/worker_pool.h>
 
 namespace lsp
 {
@@ -109,10 +110,13 @@ namespace lsp
 
                 channel_t           vChannels[meta::sampler_metadata::TRACKS_MAX];              // Temporary buffers for processing
                 dspu::Toggle        sMute;              // Mute request
+                worker_pool         sPool;              // Worker pool
                 float              *pBuffer;            // Buffer data used by vChannels
                 float               fDry;               // Dry amount
                 float               fWet;               // Wet amount
                 bool                bMuting;            // Global muting option
+                size_t              nPolyphony;         // Maximum number of voices of all instruments, 0 if not limited
+                size_t              nStealPolicy;       // Voice stealing policy for the polyphony limit of the plugin
 
                 plug::IPort        *pMidiIn;            // MIDI input port
                 plug::IPort        *pMidiOut;           // MIDI output port
@@ -127,6 +131,13 @@ namespace lsp
                 plug::IPort        *pDryWet;            // Dry/Wet balance
                 plug::IPort        *pGain;              // Output gain port
                 plug::IPort        *pEditMode;          // Edit mode
+                plug::IPort        *pResampleQuality;   // Resampling quality
+                plug::IPort        *pStretchEngine;     // Stretch engine
+                plug::IPort        *pLoopBake;          // Bake loop cross-fades
+                plug::IPort        *pHotSwap;           // Hot-swap re-rendered samples
+                plug::IPort        *pWorkers;           // Number of worker threads
+                plug::IPort        *pPolyphony;         // Maximum number of voices of all instruments
+                plug::IPort        *pStealPolicy;       // Voice stealing policy
                 plug::IPort        *pInstSel;           // Instrument selector
                 plug::IPort        *pDOGain;            // Direct output gain flag
                 plug::IPort        *pDOPan;             // Direct output panning flag
@@ -134,6 +145,7 @@ namespace lsp
 
             protected:
                 void            process_trigger_events();
+                void            limit_polyphony();
 
                 void            dump_sampler(dspu::IStateDumper *v, const sampler_t *s) const;
                 void            dump_channel(dspu::IStateDumper *v, const channel_t *s) const;
@@ -142,6 +154,7 @@ namespace lsp
 
             protected:
                 static uint32_t select_channels(size_t index);
+                static bool     key_matches(const sampler_t *s, size_t pitch);
 
             public:
                 explicit        sampler(const meta::plugin_t *metadata, size_t samplers, size_t channels, bool dry_ports);
@@ -28,15 +28,44 @@
 #include <lsp-plug.in/dsp-units/ctl/Blink.h>
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/dsp-units/sampling/SamplePlayer.h>
+#include <lsp-plug.in/dsp-units/util/ADSREnvelope.h>
 #include <lsp-plug.in/dsp-units/util/Randomizer.h>
 #include <lsp-plug.in/lltl/parray.h>
 #include <lsp-plug.in/ipc/ITask.h>
+#include <lsp-plug.in/mm/IInAudioStream.h>
 #include <private/meta/sampler.h>
+#include <private/plugins/event_wheel.h>
+#include <private/plugins/scratch_arena.h>
+#include <private/plugins/worker_pool.h>
 
 namespace lsp
 {
     namespace plugins
     {
+        /**
+         * Policy of selecting the voice to steal when the polyphony limit is reached
+         */
+        enum steal_policy_t
+        {
+            STEAL_OLDEST,               // The oldest voice
+            STEAL_QUIETEST,             // The voice triggered with the lowest gain
+            STEAL_SAME_NOTE,            // The oldest voice of the same note
+            STEAL_RELEASED,             // The oldest voice that has been released
+
+            STEAL_DFL = STEAL_OLDEST
+        };
+
+        /**
+         * Information about the voice used for selecting the voice to steal
+         */
+        typedef struct voice_info_t
+        {
+            wsize_t             nStart;         // Start time of the voice in samples
+            float               fGain;          // Gain of the voice
+            bool                bReleased;      // Voice has been released by note-off or cancel
+            bool                bSameNote;      // Voice plays the same note as the new one
+        } voice_info_t;
+
         /**
          * Sampler implementation for single-channel audio sampler
          */
@@ -45,6 +74,24 @@ namespace lsp
             protected:
                 struct afile_t;
 
+                typedef status_t (* channel_op_t)(dspu::Sample *s, const void *arg);
+
+                class ChannelTask: public ipc::ITask
+                {
+                    private:
+                        channel_op_t            pOp;
+                        dspu::Sample           *pSample;
+                        const void             *pArg;
+
+                    public:
+                        explicit ChannelTask();
+                        virtual ~ChannelTask();
+
+                    public:
+                        void                    bind(channel_op_t op, dspu::Sample *s, const void *arg);
+                        virtual status_t        run();
+                };
+
                 class AFLoader: public ipc::ITask
                 {
                     private:
@@ -65,6 +112,8 @@ namespace lsp
                     private:
                         sampler_kernel         *pCore;
                         afile_t                *pFile;
+                        ChannelTask             vTasks[meta::sampler_metadata::TRACKS_MAX];     // Tasks processing channels in parallel
+                        dspu::Sample            vParts[meta::sampler_metadata::TRACKS_MAX];     // Channels of the sample, reused between renders
 
                     public:
                         explicit AFRenderer(sampler_kernel *base, afile_t *descr);
@@ -72,6 +121,7 @@ namespace lsp
 
                     public:
                         virtual status_t        run();
+                        status_t                process_channels(dspu::Sample *s, channel_op_t op, const void *arg);
                         void                    dump(dspu::IStateDumper *v) const;
                 };
 
@@ -90,6 +140,8 @@ namespace lsp
                 };
 
             protected:
+                static constexpr size_t KEY_VARIANTS    = meta::sampler_metadata::KEY_RANGE_MAX * 2;   // Number of pitch variants of the file
+
                 enum crossfade_t
                 {
                     XFADE_LINEAR,
@@ -125,6 +177,19 @@ namespace lsp
                     ssize_t             nStretchDelta;                                  // Stretch delta
                     ssize_t             nStretchStart;                                  // Stretch start position
                     ssize_t             nStretchEnd;                                    // Stretch end position
+                    ssize_t             nLoopStart;                                     // Start of the loop with baked cross-fade
+                    ssize_t             nLoopEnd;                                       // End of the loop with baked cross-fade
+                    ssize_t             nLoopFade;                                      // Length of the baked loop cross-fade, 0 if not baked
+                    bool                bShared;                                        // Sample is shared with the render stage cache
+                    bool                bReversed;                                      // Source data outside of the cut is stored in reverse order
+                    bool                bDraft;                                         // Sample is a draft render with own thumbnails
+                };
+
+                struct render_stage_t
+                {
+                    uint64_t            nHash;                                          // Hash of parameters the stage was rendered with, 0 if invalid
+                    dspu::Sample       *pSample;                                        // Result of the stage, NULL if the stage passes the input as is
+                    render_params_t     sParams;                                        // Render parameters applied by the stage
                 };
 
                 struct afile_t
@@ -137,15 +202,26 @@ namespace lsp
                     dspu::Blink         sNoteOn;                                        // Note on led
                     dspu::Playback      vPlayback[4];                                   // Active playback handle
                     dspu::Playback      vListen[4];                                     // Listen playback handle
+                    dspu::Playback      vKeyPlayback[KEY_VARIANTS][4];                  // Active playback handles of pitch variants
                     dspu::Sample       *pOriginal;                                      // Source sample (original, as from source file)
-                    dspu::Sample       *pProcessed;                                     // Processed sample
+                    dspu::Sample       *pProcessed;                                     // Processed sample, may share data with the original
+                    dspu::Sample       *pPartial;                                       // Playable prefix of the sample being rendered
+                    dspu::Sample       *vVariants[KEY_VARIANTS];                        // Rendered pitch variants pending for bind, NULL to unbind
                     float              *vThumbs[meta::sampler_metadata::TRACKS_MAX];    // List of thumbnails
                     float              *vCutThumbs[meta::sampler_metadata::TRACKS_MAX]; // List of thumbnails with cut-off
+                    float              *vDraftThumbs[meta::sampler_metadata::TRACKS_MAX];   // List of thumbnails of the draft render
+                    float              *vDraftCutThumbs[meta::sampler_metadata::TRACKS_MAX];// List of thumbnails of the draft render with cut-off
+                    render_stage_t      sSourceStage;                                   // Resampled, reversed and compensated sample
+                    render_stage_t      sStretchStage;                                  // Stretched sample
+                    render_stage_t      sCutStage;                                      // Head and tail cut sample with applied fades
 
                     uint32_t            nUpdateReq;                                     // Update request
                     uint32_t            nUpdateResp;                                    // Update response
+                    uint32_t            nRenderSettle;                                  // Number of samples left for parameters to settle
+                    uint32_t            nRenderHold;                                    // Number of samples left until next render is allowed
                     bool                bEnvEdit;                                       // Envelope editing
                     bool                bSync;                                          // Sync flag
+                    bool                bDraftSync;                                     // Sync flag for thumbnails of the draft render
                     float               fMinVelocity;                                   // Minimum velocity
                     float               fMaxVelocity;                                   // Maximum velocity
                     float               fPitch;                                         // Pitch (st)
@@ -156,6 +232,7 @@ namespace lsp
                     float               fStretchChunk;                                  // Stretch chunk (bar)
                     float               fStretchFade;                                   // Stretch cross-fade length
                     uint32_t            nStretchFadeType;                               // Stretch cross-fade type
+                    float               fStretchRate;                                   // Processing rate of the last stretch (samples per second)
                     dspu::sample_loop_t enLoopMode;                                     // Loop mode
                     float               fLoopStart;                                     // Stretch start (ms)
                     float               fLoopEnd;                                       // Stretch end (ms)
@@ -261,9 +338,22 @@ namespace lsp
                     plug::IPort        *pMesh;                                          // Dump of the file data
                 };
 
+                struct voice_t
+                {
+                    dspu::Playback      vPlayback[4];                                   // Playbacks of the voice
+                    wsize_t             nStart;                                         // Start time of the voice in samples
+                    size_t              nFile;                                          // Index of the played file
+                    ssize_t             nKey;                                           // Key of the voice relative to the note of the instrument
+                    float               fGain;                                          // Gain of the voice
+                    bool                bReleased;                                      // Voice has been released by note-off or cancel
+                };
+
             protected:
                 ipc::IExecutor     *pExecutor;                                          // Executor service
+                worker_pool        *pPool;                                              // Worker pool of the plugin, may be NULL
                 dspu::Sample       *pGCList;                                            // Garbage collection list
+                dspu::Sample       *pGCReleased;                                        // Shared samples released by the audio thread
+                wsize_t             nGCReclaimed;                                       // Amount of memory reclaimed by garbage collector
                 afile_t            *vFiles;                                             // List of audio files
                 afile_t           **vActive;                                            // List of active audio files
                 dspu::SamplePlayer  vChannels[meta::sampler_metadata::TRACKS_MAX];      // List of channels
@@ -274,6 +364,15 @@ namespace lsp
                 dspu::Toggle        sStop;                                              // Stop listen sample preview toggle
                 dspu::Randomizer    sRandom;                                            // Randomizer
                 GCTask              sGCTask;                                            // Garbage collection task
+                event_wheel         sEvents;                                            // Trigger events scheduled for the future
+                wsize_t             nTime;                                              // Number of samples processed by the kernel
+                voice_t            *vVoices;                                            // Voices tracked for polyphony limiting
+                size_t              nVoices;                                            // Number of tracked voices
+                size_t              nPolyphony;                                         // Maximum number of voices, 0 if not limited
+                size_t              nStealPolicy;                                       // Voice stealing policy
+                size_t              nKeyRange;                                          // Key range around the note of the instrument (semitones)
+                bool                bTrackVoices;                                       // Track voices for the polyphony limit of the plugin
+                wsize_t             nLastVoice;                                         // Start time of the most recent voice
 
                 size_t              nFiles;                                             // Number of files
                 size_t              nActive;                                            // Number of active files
@@ -284,6 +383,14 @@ namespace lsp
                 bool                bHandleVelocity;                                    // Velocity handling flag
                 bool                bEnvelopeEdit;                                      // Envelope edit
                 float               fFadeout;                                           // Fadeout in milliseconds
+                float               fRenderSettle;                                      // Time for parameters to settle before render in milliseconds
+                float               fRenderInterval;                                    // Minimum interval between renders of the same file in milliseconds
+                size_t              nResampleQuality;                                   // Quality of the resampler
+                size_t              nStretchEngine;                                     // Stretch engine
+                bool                bLoopBake;                                          // Bake loop cross-fades into the sample
+                bool                bHotSwap;                                           // Keep playing voices on sample swap
+                bool                bInteractive;                                       // Instrument is being edited
+                scratch_arena       sScratch;                                           // Scratch arena for temporary render buffers
                 float               fDynamics;                                          // Dynamics
                 float               fDrift;                                             // Time drifting
                 size_t              nSampleRate;                                        // Sample rate
@@ -291,6 +398,9 @@ namespace lsp
                 plug::IPort        *pDynamics;                                          // Dynamics port
                 plug::IPort        *pHandleVelocity;                                    // Velocity handling
                 plug::IPort        *pDrift;                                             // Time drifting port
+                plug::IPort        *pPolyphony;                                         // Polyphony port
+                plug::IPort        *pStealPolicy;                                       // Voice stealing policy port
+                plug::IPort        *pKeyRange;                                          // Key range port
                 plug::IPort        *pSampleSel;                                         // Sample selector
                 plug::IPort        *pActivity;                                          // Activity port
                 plug::IPort        *pListen;                                            // Listen sample preview
@@ -300,19 +410,46 @@ namespace lsp
             protected:
                 void        destroy_state();
                 status_t    load_file(afile_t *file);
+                status_t    decode_original(dspu::Sample * &dst, const char *fname);
+                status_t    decode_file(dspu::Sample *dst, const char *fname);
                 status_t    render_sample(afile_t *af);
-                void        play_sample(afile_t *af, float gain, size_t delay, play_mode_t mode, bool listen);
+                status_t    render_identity(afile_t *af, dspu::Sample *src);
+                status_t    render_source_stage(afile_t *af, dspu::Sample *src, dspu::Sample * &dst);
+                status_t    render_stretch_stage(afile_t *af, dspu::Sample * &sample);
+                status_t    render_cut_stage(afile_t *af, dspu::Sample *src, dspu::Sample * &dst);
+                bool        is_identity_render(const afile_t *af, const dspu::Sample *src) const;
+                bool        is_reverse_folded(const afile_t *af) const;
+                bool        is_prefix_render(const afile_t *af, const dspu::Sample *src) const;
+                status_t    render_prefix(afile_t *af, dspu::Sample *src);
+                bool        is_draft_render(const afile_t *af, const dspu::Sample *src) const;
+                status_t    render_draft(afile_t *af, dspu::Sample *src);
+                status_t    render_variants(afile_t *af);
+                bool        is_loop_baked(const afile_t *af) const;
+                void        bake_loop_crossfade(const afile_t *af, dspu::Sample *s, render_params_t *rp);
+                uint64_t    source_stage_hash(const afile_t *af, const dspu::Sample *src) const;
+                uint64_t    stretch_stage_hash(const afile_t *af, size_t length) const;
+                size_t      sample_id(const afile_t *af, ssize_t key) const;
+                bool        play_sample(afile_t *af, ssize_t key, float gain, size_t delay, play_mode_t mode, bool listen);
                 void        cancel_sample(afile_t *af, size_t delay);
+                void        cancel_variants(afile_t *af, size_t delay);
+                void        bind_variants(afile_t *af);
+                bool        start_voice(afile_t *af, ssize_t key, float gain, size_t delay);
+                void        remove_voice(size_t index);
+                void        drop_voices();
+                void        release_voices(bool note_off, ssize_t key);
                 void        start_listen_file(afile_t *af, float gain);
                 void        stop_listen_file(afile_t *af, bool force);
                 void        start_listen_instrument(float velocity, float gain);
                 void        stop_listen_instrument(bool force);
 
+                bool        submit_task(ipc::ITask *task, size_t cls);
                 void        process_file_load_requests();
-                void        process_file_render_requests();
+                void        process_file_render_requests(size_t samples);
                 void        process_gc_tasks();
                 void        reorder_samples();
                 void        process_listen_events();
+                void        process_scheduled_events(size_t samples);
+                void        process_finished_voices();
                 void        play_samples(float **listen, float **outs, const float **ins, size_t samples);
                 void        output_parameters(size_t samples);
                 afile_t    *select_active_sample(float velocity);
@@ -326,9 +463,27 @@ namespace lsp
                 static void                 destroy_afile(afile_t *af);
                 static void                 destroy_samples(dspu::Sample *gc_list);
                 static void                 destroy_sample(dspu::Sample * &sample);
+                static void                 release_sample(dspu::Sample * &sample);
+                static void                 release_variants(afile_t *af);
+                static bool                 is_shared_sample(const dspu::Sample *sample);
+                static void                 drop_render_stage(render_stage_t *stage);
+                static void                 configure_envelope(dspu::ADSREnvelope *e, const afile_t *af);
+                static void                 advise_sample_memory(dspu::Sample *s);
+                static size_t               sample_bytes(const dspu::Sample *s);
+                static void                 release_heap_memory();
+                static void                 update_stretch_rate(afile_t *af, size_t samples, wssize_t started);
+                static void                 render_thumbnails(float *dst, const float *src, size_t length);
+                static void                 render_composite_thumbnails(float *dst, const float *src, const float *cut, const render_params_t *rp);
+                static void                 analyze_sample(float *thumbs, float *cut_thumbs, const float *src, const float *cut, const render_params_t *rp);
+                static void                 normalize_thumbnails(float * const *thumbs, size_t channels);
+                static status_t             decode_region(dspu::Sample *dst, mm::IInAudioStream *is, size_t stream_channels, size_t offset, size_t count);
                 static ssize_t              compute_loop_point(const dspu::Sample *s, size_t position);
+                static ssize_t              scale_position(ssize_t position, size_t length, size_t base_length);
+                static size_t               variant_slot(ssize_t key);
+                static dspu::Playback      *key_playback(afile_t *af, ssize_t key);
                 static dspu::sample_loop_t  decode_loop_mode(plug::IPort *on, plug::IPort *mode);
                 float                       compute_play_position(const afile_t *f);
+                static void                 dump_render_stage(dspu::IStateDumper *v, const char *name, const render_stage_t *s);
                 void                        dump_afile(dspu::IStateDumper *v, const afile_t *f) const;
                 void                        perform_gc();
 
@@ -342,16 +497,31 @@ namespace lsp
                 sampler_kernel & operator = (sampler_kernel &&) = delete;
 
             public:
-                void        trigger_on(size_t timestamp, uint8_t midi_velocity);
-                void        trigger_off(size_t timestamp, bool handle);
+                void        trigger_on(size_t timestamp, uint8_t midi_velocity, ssize_t key);
+                void        trigger_off(size_t timestamp, bool handle, ssize_t key);
                 void        trigger_cancel(size_t timestamp);
 
             public:
                 void        set_fadeout(float length);
                 void        set_envelope_edit(bool edit);
+                void        set_render_timing(float settle, float interval);
+                void        set_resample_quality(size_t quality);
+                void        set_stretch_engine(size_t engine);
+                void        set_loop_bake(bool bake);
+                void        set_hot_swap(bool hot_swap);
+                void        set_interactive(bool interactive);
+                void        set_voice_tracking(bool track);
+
+            public:
+                inline size_t   active_voices() const       { return nVoices;       }
+                inline wsize_t  last_voice() const          { return nLastVoice;    }
+                inline size_t   key_range() const           { return nKeyRange;     }
+                ssize_t         select_voice(voice_info_t *info, size_t policy, ssize_t file, ssize_t key) const;
+                void            steal_voice(size_t index, size_t delay);
+                static bool     steal_first(const voice_info_t *a, const voice_info_t *b, size_t policy);
 
             public:
-                bool        init(ipc::IExecutor *executor, size_t files, size_t channels);
+                bool        init(ipc::IExecutor *executor, worker_pool *pool, size_t files, size_t channels);
                 void        bind(plug::IPort **ports, size_t & port_id, bool dynamics);
                 void        bind_activity(plug::IPort **ports, size_t & port_id);
                 void        destroy();
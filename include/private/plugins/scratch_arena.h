@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_PLUGINS_SCRATCH_ARENA_H_
+#define PRIVATE_PLUGINS_SCRATCH_ARENA_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        /**
+         * Arena of aligned scratch buffers used by sample rendering. Buffers are allocated
+         * from the single memory block and are released all at once when the last render
+         * leaves the arena. If the block is exhausted, the buffer is allocated on the heap
+         * and the block grows to the high-water mark on the next release, so the repeated
+         * renders do not allocate memory anymore.
+         */
+        class scratch_arena
+        {
+            private:
+                ipc::Mutex              sLock;          // Lock
+                uint8_t                *pBlock;         // Allocated memory block
+                uint8_t                *pData;          // Aligned pointer to the memory block
+                size_t                  nCapacity;      // Capacity of the memory block in bytes
+                size_t                  nUsed;          // Number of used bytes of the memory block
+                size_t                  nRequested;     // Number of bytes requested since the last release
+                size_t                  nUsers;         // Number of renders using the arena
+                lltl::parray<uint8_t>   vOverflow;      // Heap buffers allocated when the block has been exhausted
+
+            protected:
+                void                    release();
+
+            public:
+                explicit scratch_arena();
+                scratch_arena(const scratch_arena &) = delete;
+                scratch_arena(scratch_arena &&) = delete;
+                ~scratch_arena();
+
+                scratch_arena & operator = (const scratch_arena &) = delete;
+                scratch_arena & operator = (scratch_arena &&) = delete;
+
+            public:
+                /**
+                 * Enter the arena before allocating buffers
+                 */
+                void                    begin();
+
+                /**
+                 * Leave the arena, all buffers allocated by all users become invalid when
+                 * the last user leaves the arena
+                 */
+                void                    end();
+
+                /**
+                 * Allocate the aligned buffer, the method is thread safe
+                 *
+                 * @param count number of floats to allocate
+                 * @return pointer to the buffer or NULL if there is no memory
+                 */
+                float                  *alloc(size_t count);
+
+                /**
+                 * Destroy the arena, should be called when there are no users
+                 */
+                void                    destroy();
+
+                /**
+                 * Dump the state of the arena
+                 *
+                 * @param v state dumper
+                 */
+                void                    dump(dspu::IStateDumper *v) const;
+        };
+
+    } /* namespace plugins */
+} /* namespace lsp */
+
+#endif /* PRIVATE_PLUGINS_SCRATCH_ARENA_H_ */
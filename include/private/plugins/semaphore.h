@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_PLUGINS_SEMAPHORE_H_
+#define PRIVATE_PLUGINS_SEMAPHORE_H_
+
+#include <lsp-plug.in/common/types.h>
+
+#if defined(PLATFORM_WINDOWS)
+    #include <windows.h>
+#elif defined(PLATFORM_MACOSX)
+    #include <dispatch/dispatch.h>
+#else
+    #include <semaphore.h>
+#endif
+
+namespace lsp
+{
+    namespace plugins
+    {
+        /**
+         * Counting semaphore. Posting the semaphore never blocks the caller, so it can be
+         * used to wake up the waiting threads from the audio thread.
+         */
+        class semaphore
+        {
+            private:
+            #if defined(PLATFORM_WINDOWS)
+                HANDLE                  hSem;
+            #elif defined(PLATFORM_MACOSX)
+                dispatch_semaphore_t    hSem;
+            #else
+                sem_t                   hSem;
+            #endif
+
+            public:
+                explicit semaphore();
+                semaphore(const semaphore &) = delete;
+                semaphore(semaphore &&) = delete;
+                ~semaphore();
+
+                semaphore & operator = (const semaphore &) = delete;
+                semaphore & operator = (semaphore &&) = delete;
+
+            public:
+                /**
+                 * Increment the counter of the semaphore and wake up one waiting thread
+                 */
+                void                    post();
+
+                /**
+                 * Wait until the counter of the semaphore is positive and decrement it
+                 */
+                void                    wait();
+        };
+
+    } /* namespace plugins */
+} /* namespace lsp */
+
+#endif /* PRIVATE_PLUGINS_SEMAPHORE_H_ */
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_PLUGINS_WORKER_POOL_H_
+#define PRIVATE_PLUGINS_WORKER_POOL_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/ipc/IExecutor.h>
+#include <lsp-plug.in/ipc/ITask.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <private/meta/sampler.h>
+#include <private/plugins/semaphore.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        /**
+         * Priority class of the task submitted to the worker pool, tasks of the class
+         * with lower value are executed first
+         */
+        enum task_class_t
+        {
+            TASK_INTERACTIVE,           // Render of the instrument being edited
+            TASK_LOAD,                  // Load of the file
+            TASK_RENDER,                // Background render
+            TASK_GC,                    // Garbage collection
+
+            TASK_CLASSES
+        };
+
+        /**
+         * Pool of worker threads owned by the plugin. Tasks are queued by priority classes,
+         * background renders and garbage collection never occupy all threads of the pool,
+         * so interactive renders and loads do not wait for them. Idle workers are blocked on
+         * the semaphore which is posted for each submitted task. The threads are started and
+         * stopped by the resize task that should be executed by the host executor, and the
+         * pool accepts tasks only while at least one worker thread is running. The resize task
+         * and the shutdown of the pool are serialized by the resize lock. If the host executor
+         * does not run the pending resize task in time, the shutdown cancels it, and the task
+         * does nothing when it is executed later.
+         */
+        class worker_pool: public ipc::IExecutor
+        {
+            private:
+                class Worker: public ipc::Thread
+                {
+                    private:
+                        worker_pool            *pPool;
+                        bool                    bExited;
+
+                    public:
+                        explicit Worker(worker_pool *pool);
+                        virtual ~Worker() override;
+
+                    public:
+                        virtual status_t        run() override;
+
+                        inline bool             exited() const      { return bExited;   }
+                        inline void             set_exited()        { bExited = true;   }
+                };
+
+                class Resizer: public ipc::ITask
+                {
+                    private:
+                        worker_pool            *pPool;
+
+                    public:
+                        explicit Resizer(worker_pool *pool);
+                        virtual ~Resizer() override;
+
+                    public:
+                        virtual status_t        run() override;
+                };
+
+                typedef struct entry_t
+                {
+                    ipc::ITask         *pTask;          // Task
+                    semaphore          *pDone;          // Semaphore posted when the task completes, may be NULL
+                } entry_t;
+
+                typedef struct queue_t
+                {
+                    entry_t            *vTasks;         // Ring buffer of tasks
+                    size_t              nHead;          // Index of the first task
+                    size_t              nSize;          // Number of tasks
+                } queue_t;
+
+            private:
+                ipc::Mutex              sLock;                                              // Lock
+                ipc::Mutex              sResize;                                            // Lock of the thread list owner
+                semaphore               sWork;                                              // Posted for each submitted task and each thread to stop
+                semaphore               sExit;                                              // Posted by each stopped thread
+                queue_t                 vQueues[TASK_CLASSES];                              // Queues of tasks
+                Worker                 *vWorkers[meta::sampler_metadata::WORKERS_MAX];      // Worker threads
+                Resizer                 sResizer;                                           // Task that starts and stops threads
+                size_t                  nCapacity;                                          // Capacity of each queue
+                uatomic_t               nThreads;                                           // Number of running threads
+                size_t                  nRequired;                                          // Number of requested threads
+                size_t                  nApplied;                                           // Number of threads applied by the last resize
+                size_t                  nBackground;                                        // Number of threads executing background tasks
+                size_t                  nStop;                                              // Number of threads that should exit
+                bool                    bShutdown;                                          // The pool has been shut down, resize is cancelled
+                entry_t                *pData;                                              // Allocated data
+
+            protected:
+                bool                    push(ipc::ITask *task, size_t cls, semaphore *done);
+                bool                    revoke(ipc::ITask *task, size_t cls);
+                ipc::ITask             *fetch(size_t *cls, semaphore **done);
+                void                    complete(size_t cls);
+                void                    stop_threads(size_t count);
+                void                    wait_resize();
+                void                    apply_threads(size_t required);
+                void                    resize();
+                void                    drain();
+                status_t                execute(Worker *w);
+
+            public:
+                explicit worker_pool();
+                worker_pool(const worker_pool &) = delete;
+                worker_pool(worker_pool &&) = delete;
+                virtual ~worker_pool() override;
+
+                worker_pool & operator = (const worker_pool &) = delete;
+                worker_pool & operator = (worker_pool &&) = delete;
+
+            public:
+                /**
+                 * Initialize the pool
+                 *
+                 * @param capacity maximum number of tasks that can be queued in each priority class
+                 * @return true on success
+                 */
+                bool                    init(size_t capacity);
+
+                /**
+                 * Stop all worker threads and drop the queued tasks. The pending resize task
+                 * is waited for a limited time and cancelled
+                 */
+                void                    destroy();
+
+                /**
+                 * Set the number of worker threads, the change is applied by the resize task
+                 *
+                 * @param threads number of threads, zero disables the pool
+                 */
+                void                    set_threads(size_t threads);
+
+                /**
+                 * Get the task that applies the number of worker threads, should be submitted
+                 * to the host executor when it is pending
+                 *
+                 * @return resize task or NULL if the number of threads is up to date
+                 */
+                ipc::ITask             *resize_task();
+
+                /**
+                 * Check that the pool accepts tasks
+                 *
+                 * @return true if at least one worker thread is running
+                 */
+                bool                    enabled() const;
+
+                /**
+                 * Submit the task of the specified priority class, the method does not block
+                 *
+                 * @param task task to submit
+                 * @param cls priority class of the task
+                 * @return true if the task has been submitted
+                 */
+                bool                    submit(ipc::ITask *task, size_t cls);
+
+                /**
+                 * Submit the task as a background render
+                 *
+                 * @param task task to submit
+                 * @return true if the task has been submitted
+                 */
+                virtual bool            submit(ipc::ITask *task) override;
+
+                /**
+                 * Execute the group of tasks by the worker threads and the calling thread. The tasks
+                 * that have not been started by the worker threads when the calling thread becomes
+                 * free are executed by the calling thread, so the method never waits for queued tasks
+                 * and can be called from the task executed by the pool
+                 *
+                 * @param tasks tasks to execute, should be idle
+                 * @param count number of tasks
+                 * @param cls priority class of the tasks
+                 */
+                void                    execute_group(ipc::ITask * const *tasks, size_t count, size_t cls);
+
+                virtual void            shutdown() override;
+
+                /**
+                 * Dump the state of the pool
+                 *
+                 * @param v state dumper
+                 */
+                void                    dump(dspu::IStateDumper *v) const;
+        };
+
+    } /* namespace plugins */
+} /* namespace lsp */
+
+#endif /* PRIVATE_PLUGINS_WORKER_POOL_H_ */
@@ -27,7 +27,7 @@
 
 #define LSP_PLUGINS_SAMPLER_VERSION_MAJOR                   1
 #define LSP_PLUGINS_SAMPLER_VERSION_MINOR                   0
-#define LSP_PLUGINS_SAMPLER_VERSION_MICRO                   37
+#define LSP_PLUGINS_SAMPLER_VERSION_MICRO                   38
 
 #define LSP_PLUGINS_SAMPLER_VERSION  \
     LSP_MODULE_VERSION( \
@@ -184,6 +184,101 @@ namespace lsp
             { NULL, NULL }
         };
 
+        static const port_item_t sampler_resample_quality[] =
+        {
+            { "Draft",          "sampler.resample.draft"      },
+            { "Standard",       "sampler.resample.standard"   },
+            { "Mastering",      "sampler.resample.mastering"  },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_stretch_engine[] =
+        {
+            { "Classic",        "sampler.stretch.classic"     },
+            { "WSOLA Fast",     "sampler.stretch.wsola_fast"  },
+            { "WSOLA",          "sampler.stretch.wsola"       },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_loop_xfade_mode[] =
+        {
+            { "Live",           "sampler.loop.xfade.live"     },
+            { "Baked",          "sampler.loop.xfade.baked"    },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_swap_mode[] =
+        {
+            { "Swap: Cut",      "sampler.swap.cut"            },
+            { "Swap: Keep",     "sampler.swap.keep"           },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_worker_threads[] =
+        {
+            { "Workers: Host",  "sampler.workers.host"        },
+            { "Workers: 1",     "sampler.workers.1"           },
+            { "Workers: 2",     "sampler.workers.2"           },
+            { "Workers: 3",     "sampler.workers.3"           },
+            { "Workers: 4",     "sampler.workers.4"           },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_voices[] =
+        {
+            { "Voices: All",    "sampler.voices.all"          },
+            { "Voices: 1",      "sampler.voices.1"            },
+            { "Voices: 2",      "sampler.voices.2"            },
+            { "Voices: 4",      "sampler.voices.4"            },
+            { "Voices: 8",      "sampler.voices.8"            },
+            { "Voices: 16",     "sampler.voices.16"           },
+            { "Voices: 32",     "sampler.voices.32"           },
+            { "Voices: 64",     "sampler.voices.64"           },
+            { "Voices: 128",    "sampler.voices.128"          },
+            { "Voices: 256",    "sampler.voices.256"          },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_total_voices[] =
+        {
+            { "Total: All",     "sampler.total.all"           },
+            { "Total: 16",      "sampler.total.16"            },
+            { "Total: 32",      "sampler.total.32"            },
+            { "Total: 64",      "sampler.total.64"            },
+            { "Total: 128",     "sampler.total.128"           },
+            { "Total: 256",     "sampler.total.256"           },
+            { "Total: 512",     "sampler.total.512"           },
+            { "Total: 1024",    "sampler.total.1024"          },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_steal_policy[] =
+        {
+            { "Steal: Oldest",      "sampler.steal.oldest"    },
+            { "Steal: Quietest",    "sampler.steal.quietest"  },
+            { "Steal: Same note",   "sampler.steal.same_note" },
+            { "Steal: Released",    "sampler.steal.released"  },
+            { NULL, NULL }
+        };
+
+        static const port_item_t sampler_key_range[] =
+        {
+            { "Keys: Off",      "sampler.keys.off"            },
+            { "Keys: 1",        "sampler.keys.1"              },
+            { "Keys: 2",        "sampler.keys.2"              },
+            { "Keys: 3",        "sampler.keys.3"              },
+            { "Keys: 4",        "sampler.keys.4"              },
+            { "Keys: 5",        "sampler.keys.5"              },
+            { "Keys: 6",        "sampler.keys.6"              },
+            { "Keys: 7",        "sampler.keys.7"              },
+            { "Keys: 8",        "sampler.keys.8"              },
+            { "Keys: 9",        "sampler.keys.9"              },
+            { "Keys: 10",       "sampler.keys.10"             },
+            { "Keys: 11",       "sampler.keys.11"             },
+            { "Keys: 12",       "sampler.keys.12"             },
+            { NULL, NULL }
+        };
+
         static const port_item_t sampler_midi_channels[] =
         {
             { "01",             "sampler.midi_channels.1" },
@@ -239,7 +334,14 @@ namespace lsp
             WET_GAIN(1.0f),         \
             DRYWET(100.0f),         \
             OUT_GAIN, \
-            COMBO("sets", "Sample Editor Tab Selection", "Tab selector", 0, sampler_sample_editor_tabs)
+            COMBO("sets", "Sample Editor Tab Selection", "Tab selector", 0, sampler_sample_editor_tabs), \
+            COMBO("rsq", "Resampling quality", "Resample quality", 1, sampler_resample_quality), \
+            COMBO("ste", "Stretch engine", "Stretch engine", 0, sampler_stretch_engine), \
+            COMBO("lxb", "Loop cross-fade rendering", "Loop xfade", 0, sampler_loop_xfade_mode), \
+            COMBO("hsw", "Re-rendered sample swap mode", "Swap mode", 0, sampler_swap_mode), \
+            COMBO("wth", "Worker threads", "Workers", 0, sampler_worker_threads), \
+            COMBO("gply", "Total polyphony", "Total voices", 0, sampler_total_voices), \
+            COMBO("gstl", "Total polyphony voice stealing", "Total steal", 0, sampler_steal_policy)
 
         #define S_DO_CONTROL \
             SWITCH("do_gain", "Apply gain to direct-out", "DOut gain on", 1.0f), \
@@ -315,6 +417,9 @@ namespace lsp
             CONTROL("dyna", "Dynamics", "Dynamics", U_PERCENT, sampler_metadata::DYNA), \
             CONTROL("drft", "Time drifting", "Drifting", U_MSEC, sampler_metadata::DRIFT), \
             SWITCH("hvel", "Velocity handling", "Velocity on", 1.0f), \
+            COMBO("poly", "Polyphony", "Voices", 0, sampler_voices), \
+            COMBO("vstl", "Voice stealing", "Steal", 0, sampler_steal_policy), \
+            COMBO("krng", "Key range", "Keys", 0, sampler_key_range), \
             PORT_SET("ssel", "Sample selector", sampler_sample_selectors, sample)
 
         #define S_MG_INSTRUMENT(sample)    \
@@ -330,6 +435,9 @@ namespace lsp
             CONTROL("dyna", "Dynamics", NULL, U_PERCENT, sampler_metadata::DYNA), \
             CONTROL("drft", "Time drifting", NULL, U_MSEC, sampler_metadata::DRIFT), \
             SWITCH("hvel", "Velocity handling", NULL, 1.0f), \
+            COMBO("poly", "Polyphony", NULL, 0, sampler_voices), \
+            COMBO("vstl", "Voice stealing", NULL, 0, sampler_steal_policy), \
+            COMBO("krng", "Key range", NULL, 0, sampler_key_range), \
             PORT_SET("ssel", "Sample selector", sampler_sample_selectors, sample)
 
         #define S_AREA_SELECTOR(list)     \
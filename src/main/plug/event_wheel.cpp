@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+
+#include <private/plugins/event_wheel.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        event_wheel::event_wheel()
+        {
+            for (size_t i=0; i<SLOTS; ++i)
+                vSlots[i]       = NULL;
+            pFree           = NULL;
+            vEvents         = NULL;
+            nCapacity       = 0;
+            nPending        = 0;
+        }
+
+        event_wheel::~event_wheel()
+        {
+            destroy();
+        }
+
+        bool event_wheel::init(size_t capacity)
+        {
+            trigger_event_t *events = static_cast<trigger_event_t *>(malloc(sizeof(trigger_event_t) * capacity));
+            if (events == NULL)
+                return false;
+
+            vEvents         = events;
+            nCapacity       = capacity;
+            clear();
+
+            return true;
+        }
+
+        void event_wheel::destroy()
+        {
+            for (size_t i=0; i<SLOTS; ++i)
+                vSlots[i]       = NULL;
+            pFree           = NULL;
+            nPending        = 0;
+            nCapacity       = 0;
+
+            if (vEvents != NULL)
+            {
+                free(vEvents);
+                vEvents         = NULL;
+            }
+        }
+
+        void event_wheel::clear()
+        {
+            for (size_t i=0; i<SLOTS; ++i)
+                vSlots[i]       = NULL;
+
+            pFree           = NULL;
+            for (size_t i=nCapacity; i > 0; )
+                free_event(&vEvents[--i]);
+            nPending        = 0;
+        }
+
+        inline void event_wheel::free_event(trigger_event_t *ev)
+        {
+            ev->pNext       = pFree;
+            pFree           = ev;
+        }
+
+        bool event_wheel::schedule(wsize_t start, size_t file, ssize_t key, float gain)
+        {
+            trigger_event_t *ev = pFree;
+            if (ev == NULL)
+                return false;
+            pFree           = ev->pNext;
+
+            ev->nStart      = start;
+            ev->nStop       = EVENT_NEVER;
+            ev->nCancel     = EVENT_NEVER;
+            ev->nFile       = file;
+            ev->nKey        = key;
+            ev->fGain       = gain;
+
+            trigger_event_t **slot  = &vSlots[(start >> SLOT_SHIFT) & (SLOTS - 1)];
+            ev->pNext       = *slot;
+            *slot           = ev;
+            ++nPending;
+
+            return true;
+        }
+
+        bool event_wheel::fetch(trigger_event_t *ev, wsize_t from, wsize_t to)
+        {
+            if ((nPending <= 0) || (from >= to))
+                return false;
+
+            // Look only into the slots that cover the block
+            const wsize_t first = from >> SLOT_SHIFT;
+            const wsize_t count = lsp_min(((to - 1) >> SLOT_SHIFT) - first + 1, wsize_t(SLOTS));
+
+            for (wsize_t i=0; i<count; ++i)
+            {
+                for (trigger_event_t **pp = &vSlots[(first + i) & (SLOTS - 1)]; *pp != NULL; pp = &(*pp)->pNext)
+                {
+                    trigger_event_t *e  = *pp;
+                    if (e->nStart >= to)
+                        continue;
+
+                    // Unlink the event and return it to the pool
+                    *pp             = e->pNext;
+                    *ev             = *e;
+                    ev->pNext       = NULL;
+                    free_event(e);
+                    --nPending;
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void event_wheel::stop(wsize_t time, size_t file, ssize_t key)
+        {
+            if (nPending <= 0)
+                return;
+
+            for (size_t i=0; i<SLOTS; ++i)
+            {
+                for (trigger_event_t *ev = vSlots[i]; ev != NULL; ev = ev->pNext)
+                {
+                    if ((ev->nFile == file) && (ev->nKey == key))
+                        ev->nStop       = lsp_min(ev->nStop, time);
+                }
+            }
+        }
+
+        void event_wheel::cancel(wsize_t time)
+        {
+            if (nPending <= 0)
+                return;
+
+            for (size_t i=0; i<SLOTS; ++i)
+            {
+                for (trigger_event_t **pp = &vSlots[i]; *pp != NULL; )
+                {
+                    trigger_event_t *ev = *pp;
+                    if (ev->nStart < time)
+                    {
+                        ev->nCancel     = lsp_min(ev->nCancel, time);
+                        pp              = &ev->pNext;
+                        continue;
+                    }
+
+                    // The event has not started before the cancel, drop it
+                    *pp             = ev->pNext;
+                    free_event(ev);
+                    --nPending;
+                }
+            }
+        }
+
+        void event_wheel::dump(dspu::IStateDumper *v) const
+        {
+            v->write("pFree", pFree);
+            v->write("vEvents", vEvents);
+            v->write("nCapacity", nCapacity);
+            v->write("nPending", nPending);
+        }
+
+    } /* namespace plugins */
+} /* namespace lsp */
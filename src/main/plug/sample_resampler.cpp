@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/plugins/sample_resampler.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        namespace
+        {
+            inline float sample_at(const float *src, ssize_t length, ssize_t index)
+            {
+                return ((index >= 0) && (index < length)) ? src[index] : 0.0f;
+            }
+
+            static void interpolate_cubic(float *dst, const float *src, ssize_t length, size_t offset, size_t count, double step)
+            {
+                for (size_t i=0; i<count; ++i)
+                {
+                    const double pos    = (offset + i) * step;
+                    const ssize_t idx   = pos;
+                    const float t       = pos - idx;
+
+                    // Fetch four neighbour points, the data outside of the sample is silence
+                    float s0, s1, s2, s3;
+                    if ((idx >= 1) && (idx + 2 < length))
+                    {
+                        const float *p      = &src[idx - 1];
+                        s0                  = p[0];
+                        s1                  = p[1];
+                        s2                  = p[2];
+                        s3                  = p[3];
+                    }
+                    else
+                    {
+                        s0                  = sample_at(src, length, idx - 1);
+                        s1                  = sample_at(src, length, idx);
+                        s2                  = sample_at(src, length, idx + 1);
+                        s3                  = sample_at(src, length, idx + 2);
+                    }
+
+                    // Catmull-Rom spline
+                    const float a       = 1.5f * (s1 - s2) + 0.5f * (s3 - s0);
+                    const float b       = s0 - 2.5f * s1 + 2.0f * s2 - 0.5f * s3;
+                    const float c       = 0.5f * (s2 - s0);
+                    dst[i]              = ((a * t + b) * t + c) * t + s1;
+                }
+            }
+
+            typedef struct kernel_quality_t
+            {
+                size_t      nTaps;          // Number of kernel taps for the full-band kernel
+                size_t      nPhases;        // Number of kernel phases
+                float       fBeta;          // Kaiser window parameter
+                float       fCutoff;        // Cutoff frequency relative to the Nyquist frequency
+            } kernel_quality_t;
+
+            static const kernel_quality_t kernel_qualities[] =
+            {
+                {   8,      32,     5.0f,   0.80f   },  // RESAMPLE_DRAFT
+                {   32,     256,    8.0f,   0.90f   },  // RESAMPLE_STANDARD
+                {   96,     1024,   11.0f,  0.95f   }   // RESAMPLE_MASTERING
+            };
+
+            // Maximum number of kernel taps when downsampling
+            static constexpr size_t KERNEL_TAPS_MAX     = 1024;
+            // Number of floats in SIMD register used for padding of kernel phases
+            static constexpr size_t KERNEL_TAPS_ALIGN   = DEFAULT_ALIGN / sizeof(float);
+
+            // Zero-order modified Bessel function of the first kind
+            static double bessel_i0(double x)
+            {
+                double sum      = 1.0;
+                double term     = 1.0;
+                const double k  = 0.25 * x * x;
+                for (size_t i=1; i<64; ++i)
+                {
+                    term           *= k / double(i * i);
+                    sum            += term;
+                    if (term < sum * 1e-12)
+                        break;
+                }
+                return sum;
+            }
+        } /* namespace */
+
+        bool sample_resampler::cubic_supported(const dspu::Sample *src, size_t sample_rate)
+        {
+            return (src->sample_rate() > 0) && (sample_rate >= src->sample_rate());
+        }
+
+        void sample_resampler::cubic_read(float *dst, const float *src, size_t length,
+            size_t src_rate, size_t dst_rate, size_t offset, size_t count)
+        {
+            const double step       = double(src_rate) / double(dst_rate);
+            interpolate_cubic(dst, src, length, offset, count, step);
+        }
+
+        //-------------------------------------------------------------------------
+        polyphase_resampler::polyphase_resampler()
+        {
+            vKernel         = NULL;
+            nTaps           = 0;
+            nPhases         = 0;
+            nSrcRate        = 0;
+            nDstRate        = 0;
+            nQuality        = RESAMPLE_DFL;
+            pData           = NULL;
+        }
+
+        polyphase_resampler::~polyphase_resampler()
+        {
+            destroy();
+        }
+
+        void polyphase_resampler::destroy()
+        {
+            free_aligned(pData);
+            vKernel         = NULL;
+            nTaps           = 0;
+            nPhases         = 0;
+        }
+
+        status_t polyphase_resampler::init(size_t src_rate, size_t dst_rate, size_t quality, scratch_arena *scratch)
+        {
+            if ((src_rate <= 0) || (dst_rate <= 0))
+                return STATUS_BAD_ARGUMENTS;
+
+            const kernel_quality_t *kq  = &kernel_qualities[lsp_min(quality, size_t(RESAMPLE_MASTERING))];
+
+            // When downsampling, the kernel becomes wider proportionally to the cutoff frequency
+            const double ratio      = lsp_min(double(dst_rate) / double(src_rate), 1.0);
+            const double cutoff     = kq->fCutoff * ratio;
+            size_t taps             = lsp_min(size_t(ceil(kq->nTaps / ratio)), KERNEL_TAPS_MAX);
+            taps                    = align_size(taps, KERNEL_TAPS_ALIGN);
+
+            // Allocate the table of phases, one extra phase is used for interpolation
+            const size_t phases     = kq->nPhases;
+            uint8_t *data           = NULL;
+            float *kernel           = (scratch != NULL) ?
+                scratch->alloc(taps * (phases + 1)) :
+                alloc_aligned<float>(data, taps * (phases + 1));
+            if (kernel == NULL)
+                return STATUS_NO_MEM;
+
+            // Compute the windowed sinc kernel for each phase and normalize it to unity gain
+            const ssize_t half      = taps / 2;
+            const double i_beta     = 1.0 / bessel_i0(kq->fBeta);
+            for (size_t i=0; i<=phases; ++i)
+            {
+                float *k                = &kernel[i * taps];
+                const double frac       = double(i) / double(phases);
+                double sum              = 0.0;
+
+                for (ssize_t j=0; j<ssize_t(taps); ++j)
+                {
+                    const double t          = double(j - half + 1) - frac;
+                    const double x          = t / double(half);
+                    const double w          = (fabs(x) < 1.0) ? bessel_i0(kq->fBeta * sqrt(1.0 - x * x)) * i_beta : 0.0;
+                    const double a          = M_PI * cutoff * t;
+                    const double v          = (fabs(a) > 1e-9) ? sin(a) / a : 1.0;
+
+                    k[j]                    = v * w;
+                    sum                    += k[j];
+                }
+
+                if (sum > 0.0)
+                    dsp::mul_k2(k, 1.0 / sum, taps);
+            }
+
+            // Commit the state
+            destroy();
+            vKernel         = kernel;
+            nTaps           = taps;
+            nPhases         = phases;
+            nSrcRate        = src_rate;
+            nDstRate        = dst_rate;
+            nQuality        = quality;
+            pData           = data;
+
+            return STATUS_OK;
+        }
+
+        size_t polyphase_resampler::resampled_length(size_t length) const
+        {
+            return (nSrcRate > 0) ? (wsize_t(length) * nDstRate + nSrcRate - 1) / nSrcRate : 0;
+        }
+
+        void polyphase_resampler::process(float *dst, const float *src, size_t length, size_t offset, size_t count) const
+        {
+            const ssize_t half      = nTaps / 2;
+            const ssize_t slength   = length;
+
+            // Buffer for the source data near the bounds of the sample
+            float edge[KERNEL_TAPS_MAX];
+
+            wsize_t pos             = wsize_t(offset) * nSrcRate;
+            for (size_t i=0; i<count; ++i, pos += nSrcRate)
+            {
+                const ssize_t idx       = pos / nDstRate;
+                const wsize_t rem       = pos % nDstRate;
+
+                // Compute the phase of the kernel
+                const double fphase     = double(rem) * double(nPhases) / double(nDstRate);
+                const size_t phase      = fphase;
+                const float t           = fphase - phase;
+                const float *k          = &vKernel[phase * nTaps];
+
+                // Fetch the source data, the data outside of the sample is silence
+                const ssize_t first     = idx - half + 1;
+                const float *s;
+                if ((first >= 0) && (first + half * 2 <= slength))
+                    s                       = &src[first];
+                else
+                {
+                    dsp::fill_zero(edge, nTaps);
+                    const ssize_t from      = lsp_max(first, 0);
+                    const ssize_t to        = lsp_min(first + half * 2, slength);
+                    if (to > from)
+                        dsp::copy(&edge[from - first], &src[from], to - from);
+                    s                       = edge;
+                }
+
+                // Interpolate between two adjacent phases
+                const float s0          = dsp::h_dotp(s, k, nTaps);
+                const float s1          = (t > 0.0f) ? dsp::h_dotp(s, &k[nTaps], nTaps) : s0;
+                dst[i]                  = s0 + (s1 - s0) * t;
+            }
+        }
+
+        status_t polyphase_resampler::resample(dspu::Sample *s) const
+        {
+            if (vKernel == NULL)
+                return STATUS_BAD_STATE;
+
+            const size_t channels   = s->channels();
+            const size_t length     = s->length();
+            const size_t count      = resampled_length(length);
+
+            dspu::Sample temp;
+            if (!temp.init(channels, count, count))
+                return STATUS_NO_MEM;
+            temp.set_sample_rate(nDstRate);
+
+            for (size_t i=0; i<channels; ++i)
+                process(temp.channel(i), s->channel(i), length, 0, count);
+
+            s->swap(&temp);
+
+            return STATUS_OK;
+        }
+
+        void polyphase_resampler::dump(dspu::IStateDumper *v) const
+        {
+            v->write("vKernel", vKernel);
+            v->write("nTaps", nTaps);
+            v->write("nPhases", nPhases);
+            v->write("nSrcRate", nSrcRate);
+            v->write("nDstRate", nDstRate);
+            v->write("nQuality", nQuality);
+            v->write("pData", pData);
+        }
+
+    } /* namespace plugins */
+} /* namespace lsp */
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/plugins/sample_stretcher.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        namespace
+        {
+            typedef struct wsola_mode_t
+            {
+                float       fFrame;         // Length of the frame (ms)
+                float       fTolerance;     // Tolerance of the frame position (ms)
+                size_t      nStep;          // Step of the coarse search
+            } wsola_mode_t;
+
+            static const wsola_mode_t wsola_modes[] =
+            {
+                {   80.0f,  5.0f,   4   },  // STRETCH_WSOLA_FAST
+                {   40.0f,  10.0f,  1   }   // STRETCH_WSOLA
+            };
+
+            typedef struct wsola_params_t
+            {
+                size_t      nFrame;         // Length of the frame (samples)
+                size_t      nTolerance;     // Tolerance of the frame position (samples)
+                size_t      nStep;          // Step of the coarse search
+            } wsola_params_t;
+
+            // Reader of the source data stored in memory
+            typedef struct direct_reader_t
+            {
+                const float                *pSrc;
+
+                inline const float *fetch(size_t offset, size_t count)
+                {
+                    return &pSrc[offset];
+                }
+            } direct_reader_t;
+
+            // Reader of the source data resampled on the fly
+            typedef struct resample_reader_t
+            {
+                const polyphase_resampler  *pResampler;
+                const float                *pSrc;
+                size_t                      nLength;
+                float                      *vBuffer;
+
+                inline const float *fetch(size_t offset, size_t count)
+                {
+                    pResampler->process(vBuffer, pSrc, nLength, offset, count);
+                    return vBuffer;
+                }
+            } resample_reader_t;
+
+            static bool wsola_params(wsola_params_t *p, size_t engine, size_t sample_rate)
+            {
+                if ((engine != STRETCH_WSOLA_FAST) && (engine != STRETCH_WSOLA))
+                    return false;
+
+                const wsola_mode_t *m   = &wsola_modes[engine - STRETCH_WSOLA_FAST];
+                p->nFrame               = align_size(dspu::millis_to_samples(sample_rate, m->fFrame), 2);
+                p->nTolerance           = dspu::millis_to_samples(sample_rate, m->fTolerance);
+                p->nStep                = m->nStep;
+
+                return p->nFrame > 0;
+            }
+
+            // Normalized cross-correlation of the candidate with the template
+            inline float similarity(const float *tpl, const float *cand, size_t count)
+            {
+                const float e   = dsp::h_dotp(cand, cand, count);
+                return (e > 1e-18f) ? dsp::h_dotp(tpl, cand, count) / sqrtf(e) : 0.0f;
+            }
+
+            template <class R>
+            static void wsola_process(float *dst, size_t dst_length, R & reader, size_t src_length,
+                const wsola_params_t *p, const float *fade_in, const float *fade_out)
+            {
+                const size_t frame      = p->nFrame;
+                const size_t overlap    = frame / 2;
+                const size_t hop        = frame - overlap;
+                const ssize_t tolerance = p->nTolerance;
+                const ssize_t step      = p->nStep;
+                const ssize_t last      = src_length - frame;
+                const double a_hop      = double(hop) * double(src_length) / double(dst_length);
+
+                // The first frame is copied as is
+                dsp::copy(dst, reader.fetch(0, frame), lsp_min(frame, dst_length));
+
+                for (size_t k=1, offset=hop; offset < dst_length; ++k, offset += hop)
+                {
+                    // The output produced by the previous frame is the template for the search
+                    const float *tpl        = &dst[offset];
+                    const size_t count      = dst_length - offset;
+                    const size_t corr       = lsp_min(count, overlap);
+                    const ssize_t expected  = lsp_limit(ssize_t(k * a_hop), ssize_t(0), last);
+                    const ssize_t first     = lsp_max(expected - tolerance, ssize_t(0));
+                    const ssize_t end       = lsp_min(expected + tolerance, last);
+                    const float *w          = reader.fetch(first, end - first + frame);
+
+                    // Coarse search of the most similar frame
+                    ssize_t best            = expected - first;
+                    float best_sim          = similarity(tpl, &w[best], corr);
+                    for (ssize_t q=0; q <= end - first; q += step)
+                    {
+                        const float sim         = similarity(tpl, &w[q], corr);
+                        if (sim > best_sim)
+                        {
+                            best                    = q;
+                            best_sim                = sim;
+                        }
+                    }
+
+                    // Refine the position found by the coarse search
+                    if (step > 1)
+                    {
+                        const ssize_t r_first   = lsp_max(best - step + 1, ssize_t(0));
+                        const ssize_t r_end     = lsp_min(best + step - 1, end - first);
+                        for (ssize_t q=r_first; q <= r_end; ++q)
+                        {
+                            const float sim         = similarity(tpl, &w[q], corr);
+                            if (sim > best_sim)
+                            {
+                                best                    = q;
+                                best_sim                = sim;
+                            }
+                        }
+                    }
+
+                    // Cross-fade the overlapping part and copy the rest of the frame
+                    const float *s          = &w[best];
+                    float *d                = &dst[offset];
+                    dsp::mul2(d, fade_out, corr);
+                    dsp::fmadd3(d, s, fade_in, corr);
+                    if (count > overlap)
+                        dsp::copy(&d[overlap], &s[overlap], lsp_min(frame - overlap, count - overlap));
+                }
+            }
+
+            static float *alloc_fades(uint8_t * &data, scratch_arena *scratch, size_t overlap, size_t extra)
+            {
+                // Cross-fade windows for the overlapping part of frames, followed by extra space
+                float *fade_in          = (scratch != NULL) ?
+                    scratch->alloc(overlap * 2 + extra) :
+                    alloc_aligned<float>(data, overlap * 2 + extra);
+                if (fade_in == NULL)
+                    return NULL;
+
+                float *fade_out         = &fade_in[overlap];
+                for (size_t i=0; i<overlap; ++i)
+                {
+                    fade_in[i]              = (i + 0.5f) / overlap;
+                    fade_out[i]             = 1.0f - fade_in[i];
+                }
+
+                return fade_in;
+            }
+        } /* namespace */
+
+        bool sample_stretcher::supported(size_t engine, size_t sample_rate, size_t src_length, size_t dst_length)
+        {
+            wsola_params_t p;
+            if (!wsola_params(&p, engine, sample_rate))
+                return false;
+
+            // The source and the result should fit at least two frames
+            return (src_length >= p.nFrame * 2) && (dst_length >= p.nFrame * 2);
+        }
+
+        status_t sample_stretcher::stretch(dspu::Sample *s, size_t engine, size_t length, size_t start, size_t end, scratch_arena *scratch)
+        {
+            const size_t s_length   = s->length();
+            end                     = lsp_min(end, s_length);
+            if (start > end)
+                return STATUS_BAD_ARGUMENTS;
+            if (!supported(engine, s->sample_rate(), end - start, length))
+                return STATUS_UNSUPPORTED;
+
+            wsola_params_t p;
+            wsola_params(&p, engine, s->sample_rate());
+
+            // Form the stretched sample
+            const size_t channels   = s->channels();
+            const size_t tail       = s_length - end;
+            const size_t d_length   = start + length + tail;
+
+            dspu::Sample temp;
+            if (!temp.init(channels, d_length, d_length))
+                return STATUS_NO_MEM;
+            temp.set_sample_rate(s->sample_rate());
+
+            uint8_t *data           = NULL;
+            const size_t overlap    = p.nFrame / 2;
+            float *fade_in          = alloc_fades(data, scratch, overlap, 0);
+            if (fade_in == NULL)
+                return STATUS_NO_MEM;
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                const float *src        = s->channel(i);
+                float *dst              = temp.channel(i);
+
+                direct_reader_t reader;
+                reader.pSrc             = &src[start];
+
+                dsp::copy(dst, src, start);
+                wsola_process(&dst[start], length, reader, end - start, &p, fade_in, &fade_in[overlap]);
+                dsp::copy(&dst[start + length], &src[end], tail);
+            }
+
+            free_aligned(data);
+            s->swap(&temp);
+
+            return STATUS_OK;
+        }
+
+        status_t sample_stretcher::pitch_shift(dspu::Sample *s, size_t engine, const polyphase_resampler *r, size_t length, scratch_arena *scratch)
+        {
+            const size_t s_length   = s->length();
+            const size_t r_length   = r->resampled_length(s_length);
+            if (!supported(engine, r->dst_rate(), r_length, length))
+                return STATUS_UNSUPPORTED;
+
+            wsola_params_t p;
+            wsola_params(&p, engine, r->dst_rate());
+
+            const size_t channels   = s->channels();
+            dspu::Sample temp;
+            if (!temp.init(channels, length, length))
+                return STATUS_NO_MEM;
+            temp.set_sample_rate(r->dst_rate());
+
+            // The buffer should fit the whole search window of the frame
+            uint8_t *data           = NULL;
+            const size_t overlap    = p.nFrame / 2;
+            float *fade_in          = alloc_fades(data, scratch, overlap, p.nFrame + p.nTolerance * 2 + 1);
+            if (fade_in == NULL)
+                return STATUS_NO_MEM;
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                resample_reader_t reader;
+                reader.pResampler       = r;
+                reader.pSrc             = s->channel(i);
+                reader.nLength          = s_length;
+                reader.vBuffer          = &fade_in[overlap * 2];
+
+                wsola_process(temp.channel(i), length, reader, r_length, &p, fade_in, &fade_in[overlap]);
+            }
+
+            free_aligned(data);
+            s->swap(&temp);
+
+            return STATUS_OK;
+        }
+
+    } /* namespace plugins */
+} /* namespace lsp */
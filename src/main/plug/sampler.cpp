@@ -85,6 +85,8 @@ namespace lsp
             nSamplers       = lsp_min(meta::sampler_metadata::INSTRUMENTS_MAX, samplers);
             nFiles          = meta::sampler_metadata::SAMPLE_FILES;
             nDOMode         = 0;
+            nPolyphony      = 0;
+            nStealPolicy    = STEAL_DFL;
             bDryPorts       = dry_ports;
             vSamplers       = NULL;
 
@@ -119,6 +121,13 @@ namespace lsp
             pDryWet         = NULL;
             pGain           = NULL;
             pEditMode       = NULL;
+            pResampleQuality = NULL;
+            pStretchEngine  = NULL;
+            pLoopBake       = NULL;
+            pHotSwap        = NULL;
+            pWorkers        = NULL;
+            pPolyphony      = NULL;
+            pStealPolicy    = NULL;
             pInstSel        = NULL;
             pDOGain         = NULL;
             pDOPan          = NULL;
@@ -144,8 +153,9 @@ namespace lsp
             // Initialize toggle
             sMute.init();
 
-            // Initialize samplers
+            // Initialize samplers, the worker pool can execute all tasks of all samplers at once
             ipc::IExecutor *executor    = wrapper->executor();
+            worker_pool *pool           = (sPool.init(nSamplers * (nFiles * 2 + 1))) ? &sPool : NULL;
 
             for (size_t i=0; i<nSamplers; ++i)
             {
@@ -154,7 +164,7 @@ namespace lsp
 
                 // Initialize sampler
                 lsp_trace("Initializing sampler #%d...", int(i));
-                if (!s->sSampler.init(executor, nFiles, nChannels))
+                if (!s->sSampler.init(executor, pool, nFiles, nChannels))
                     return;
 
                 s->nNote        = meta::sampler_metadata::NOTE_DFL + meta::sampler_metadata::OCTAVE_DFL * 12;
@@ -240,6 +250,13 @@ namespace lsp
             BIND_PORT(pDryWet);
             BIND_PORT(pGain);
             BIND_PORT(pEditMode);
+            BIND_PORT(pResampleQuality);
+            BIND_PORT(pStretchEngine);
+            BIND_PORT(pLoopBake);
+            BIND_PORT(pHotSwap);
+            BIND_PORT(pWorkers);
+            BIND_PORT(pPolyphony);
+            BIND_PORT(pStealPolicy);
             if (bDryPorts)
             {
                 BIND_PORT(pDOGain);
@@ -333,6 +350,12 @@ namespace lsp
             return 1 << index;
         }
 
+        bool sampler::key_matches(const sampler_t *s, size_t pitch)
+        {
+            const size_t range  = s->sSampler.key_range();
+            return (pitch + range >= s->nNote) && (pitch <= s->nNote + range);
+        }
+
         void sampler::destroy()
         {
             plug::Module::destroy();
@@ -340,6 +363,9 @@ namespace lsp
 
         void sampler::do_destroy()
         {
+            // Stop worker threads before destroying the tasks
+            sPool.destroy();
+
             if (vSamplers != NULL)
             {
                 for (size_t i=0; i<nSamplers; ++i)
@@ -415,6 +441,14 @@ namespace lsp
                     vChannels[i].sBypass.set_bypass(bypass);
             }
 
+            // Update number of worker threads
+            sPool.set_threads(pWorkers->value());
+
+            // Update polyphony limit, the list of limits contains powers of two starting with 16
+            const size_t poly   = pPolyphony->value();
+            nPolyphony      = (poly > 0) ? lsp_min(size_t(8) << poly, meta::sampler_metadata::TOTAL_VOICES_MAX) : 0;
+            nStealPolicy    = pStealPolicy->value();
+
             // Update settings on all samplers and triggers
             bMuting         = pMuting->value() >= 0.5f;
             bool note_off   = pNoteOff->value() >= 0.5f;
@@ -479,6 +513,12 @@ namespace lsp
 
                 // Additional parameters
                 s->sSampler.set_fadeout(pFadeout->value());
+                s->sSampler.set_resample_quality(pResampleQuality->value());
+                s->sSampler.set_stretch_engine(pStretchEngine->value());
+                s->sSampler.set_loop_bake(pLoopBake->value() >= 0.5f);
+                s->sSampler.set_hot_swap(pHotSwap->value() >= 0.5f);
+                s->sSampler.set_interactive(i == inst);
+                s->sSampler.set_voice_tracking(nPolyphony > 0);
                 s->sSampler.set_envelope_edit((i == inst) && (env_ed));
                 s->sSampler.update_settings();
             }
@@ -563,11 +603,11 @@ namespace lsp
                             ts[j]       = 0;
                         }
 
-                        // Scan state of samplers
+                        // Scan state of samplers, the instrument responds to the keys within its key range
                         for (size_t j=0; j<nSamplers; ++j)
                         {
                             sampler_t *s = &vSamplers[j];
-                            if ((me->note.pitch != s->nNote) || (!(s->nChannelMap & (1 << me->channel))))
+                            if ((!key_matches(s, me->note.pitch)) || (!(s->nChannelMap & (1 << me->channel))))
                                 continue;
 
                             size_t g    = s->nMuteGroup;
@@ -584,7 +624,7 @@ namespace lsp
                             bool triggered  = ts[j >> 5] & (1 << (j & 0x1f));
 
                             if (triggered)
-                                s->sSampler.trigger_on(me->timestamp, me->note.velocity);
+                                s->sSampler.trigger_on(me->timestamp, me->note.velocity, ssize_t(me->note.pitch) - ssize_t(s->nNote));
                             else if (muted)
                                 s->sSampler.trigger_cancel(me->timestamp);
                         }
@@ -599,13 +639,13 @@ namespace lsp
                         for (size_t j=0; j<nSamplers; ++j)
                         {
                             sampler_t *s = &vSamplers[j];
-                            if ((me->note.pitch != s->nNote) || (!(s->nChannelMap & (1 << me->channel))))
+                            if ((!key_matches(s, me->note.pitch)) || (!(s->nChannelMap & (1 << me->channel))))
                                 continue;
 
                             if (s->bMuting)
                                 s->sSampler.trigger_cancel(me->timestamp);
                             else
-                                s->sSampler.trigger_off(me->timestamp, s->bNoteOff);
+                                s->sSampler.trigger_off(me->timestamp, s->bNoteOff, ssize_t(me->note.pitch) - ssize_t(s->nNote));
                         }
                         break;
                     }
@@ -635,8 +675,66 @@ namespace lsp
             } // for i
         }
 
+        void sampler::limit_polyphony()
+        {
+            if (nPolyphony <= 0)
+                return;
+
+            // Count voices and find the instrument that has started the most recent voice
+            size_t voices           = 0;
+            sampler_kernel *recent  = NULL;
+            for (size_t i=0; i<nSamplers; ++i)
+            {
+                sampler_kernel *k       = &vSamplers[i].sSampler;
+                voices                 += k->active_voices();
+                if ((k->active_voices() > 0) && ((recent == NULL) || (k->last_voice() > recent->last_voice())))
+                    recent                  = k;
+            }
+            if (voices <= nPolyphony)
+                return;
+
+            // The note is considered retriggered if the instrument plays other voices
+            if ((recent != NULL) && (recent->active_voices() <= 1))
+                recent                  = NULL;
+
+            // Steal voices of all instruments according to the policy
+            while (voices > nPolyphony)
+            {
+                sampler_kernel *victim  = NULL;
+                ssize_t index           = -1;
+                voice_info_t best;
+
+                for (size_t i=0; i<nSamplers; ++i)
+                {
+                    sampler_kernel *k       = &vSamplers[i].sSampler;
+                    voice_info_t info;
+                    const ssize_t idx       = k->select_voice(&info, nStealPolicy, -1, 0);
+                    if (idx < 0)
+                        continue;
+
+                    info.bSameNote          = (k == recent);
+                    if ((victim == NULL) || (sampler_kernel::steal_first(&info, &best, nStealPolicy)))
+                    {
+                        victim                  = k;
+                        index                   = idx;
+                        best                    = info;
+                    }
+                }
+
+                if (victim == NULL)
+                    break;
+                victim->steal_voice(index, 0);
+                --voices;
+            }
+        }
+
         void sampler::process(size_t samples)
         {
+            // Start or stop worker threads by the host executor
+            ipc::ITask *resize  = sPool.resize_task();
+            if (resize != NULL)
+                pWrapper->executor()->submit(resize);
+
             // Process all MIDI events
             process_trigger_events();
 
@@ -682,6 +780,9 @@ namespace lsp
                     dsp::fill_zero(c->vOut, count);
                 }
 
+                // Keep the number of voices of all instruments within the limit
+                limit_polyphony();
+
                 // Execute all samplers
                 for (size_t i=0; i<nSamplers; ++i)
                 {
@@ -847,11 +948,14 @@ namespace lsp
             v->end_array();
 
             v->write_object("sMute", &sMute);
+            v->write_object("sPool", &sPool);
 
             v->write("pBuffer", pBuffer);
             v->write("fDry", fDry);
             v->write("fWet", fWet);
             v->write("bMuting", bMuting);
+            v->write("nPolyphony", nPolyphony);
+            v->write("nStealPolicy", nStealPolicy);
 
             v->write("pMidiIn", pMidiIn);
             v->write("pMidiOut", pMidiOut);
@@ -866,6 +970,13 @@ namespace lsp
             v->write("pDryWet", pDryWet);
             v->write("pGain", pGain);
             v->write("pEditMode", pEditMode);
+            v->write("pResampleQuality", pResampleQuality);
+            v->write("pStretchEngine", pStretchEngine);
+            v->write("pLoopBake", pLoopBake);
+            v->write("pHotSwap", pHotSwap);
+            v->write("pWorkers", pWorkers);
+            v->write("pPolyphony", pPolyphony);
+            v->write("pStealPolicy", pStealPolicy);
             v->write("pDOGain", pDOGain);
             v->write("pDOPan", pDOPan);
         }
@@ -27,14 +27,167 @@
 #include <lsp-plug.in/dsp-units/sampling/PlaySettings.h>
 #include <lsp-plug.in/dsp-units/util/ADSREnvelope.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
+#include <lsp-plug.in/runtime/system.h>
 #include <lsp-plug.in/shared/debug.h>
+#include <lsp-plug.in/stdlib/math.h>
 
+#include <private/plugins/sample_resampler.h>
+#include <private/plugins/sample_stretcher.h>
 #include <private/plugins/sampler_kernel.h>
 
+#ifdef PLATFORM_LINUX
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif /* PLATFORM_LINUX */
+
+#ifdef __GLIBC__
+    #include <malloc.h>
+#endif /* __GLIBC__ */
+
 namespace lsp
 {
     namespace plugins
     {
+        namespace
+        {
+            // Samples of this size and above are advised to be backed by huge pages
+            static constexpr size_t HUGE_PAGE_THRESHOLD     = 0x200000;
+            // Maximum amount of sample memory released by one garbage collection run
+            static constexpr size_t GC_SLICE_BYTES          = 0x2000000;
+            // Amount of released memory that triggers returning free heap pages to the system
+            static constexpr size_t GC_TRIM_THRESHOLD       = 0x400000;
+
+            // Length of the sample prefix published before the full render completes (ms)
+            static constexpr float RENDER_PREFIX_LENGTH     = 500.0f;
+            // Expected duration of the full render that requires the draft render to be published first (ms)
+            static constexpr float RENDER_DRAFT_THRESHOLD   = 250.0f;
+            // Length of the sample that requires the draft render if the processing rate is not known yet (ms)
+            static constexpr float RENDER_DRAFT_LENGTH      = 10000.0f;
+
+            // FNV-1a hashing of render stage parameters
+            static constexpr uint64_t STAGE_HASH_BASIS      = 0xcbf29ce484222325ULL;
+            static constexpr uint64_t STAGE_HASH_PRIME      = 0x100000001b3ULL;
+
+            template <class T>
+            inline uint64_t stage_hash(uint64_t hash, const T & value)
+            {
+                const uint8_t *ptr  = reinterpret_cast<const uint8_t *>(&value);
+                for (size_t i=0; i<sizeof(T); ++i)
+                    hash                = (hash ^ ptr[i]) * STAGE_HASH_PRIME;
+                return hash;
+            }
+
+            inline uint64_t stage_hash_commit(uint64_t hash)
+            {
+                // Zero hash is reserved for invalid stages
+                return (hash != 0) ? hash : 1;
+            }
+
+            // Peak of the range of the data which can be stored in reverse order
+            inline float range_abs_max(const float *src, ssize_t length, ssize_t first, ssize_t count, bool reversed)
+            {
+                return dsp::abs_max((reversed) ? &src[length - first - count] : &src[first], count);
+            }
+
+            // Minimum sample length to process channels of the sample in parallel
+            static constexpr size_t PARALLEL_RENDER_THRESHOLD   = 0x10000;
+
+            typedef struct source_op_t
+            {
+                const polyphase_resampler  *pResampler;     // Resampler, NULL if resampling is not required
+                scratch_arena              *pScratch;       // Scratch arena for temporary buffers
+                bool                        bReverse;       // Reverse the sample
+                bool                        bCompensate;    // Compensate the length of the sample
+                size_t                      nEngine;        // Compensation stretch engine
+                size_t                      nLength;        // Compensated length
+                size_t                      nChunkSize;     // Compensation chunk size
+                dspu::sample_crossfade_t    enFadeType;     // Compensation cross-fade type
+                float                       fCrossfade;     // Compensation cross-fade length
+            } source_op_t;
+
+            typedef struct stretch_op_t
+            {
+                size_t                      nEngine;        // Stretch engine
+                scratch_arena              *pScratch;       // Scratch arena for temporary buffers
+                size_t                      nLength;        // Length of the stretched region
+                size_t                      nChunkSize;     // Stretch chunk size
+                dspu::sample_crossfade_t    enFadeType;     // Stretch cross-fade type
+                float                       fCrossfade;     // Stretch cross-fade length
+                size_t                      nStart;         // Start of the stretched region
+                size_t                      nEnd;           // End of the stretched region
+            } stretch_op_t;
+
+            static status_t source_op(dspu::Sample *s, const void *arg)
+            {
+                const source_op_t *op   = static_cast<const source_op_t *>(arg);
+
+                // Pitch shift with compensation is performed by the stretch engine in one pass
+                // without storing the resampled data
+                if ((op->bCompensate) && (op->pResampler != NULL) &&
+                    (sample_stretcher::supported(op->nEngine, op->pResampler->dst_rate(),
+                        op->pResampler->resampled_length(s->length()), op->nLength)))
+                {
+                    if (op->bReverse)
+                        s->reverse();
+                    return sample_stretcher::pitch_shift(s, op->nEngine, op->pResampler, op->nLength, op->pScratch);
+                }
+
+                if ((op->pResampler != NULL) && (op->pResampler->resample(s) != STATUS_OK))
+                    return STATUS_NO_MEM;
+                if (op->bReverse)
+                    s->reverse();
+                if (!op->bCompensate)
+                    return STATUS_OK;
+
+                status_t res            = sample_stretcher::stretch(s, op->nEngine, op->nLength, 0, s->length(), op->pScratch);
+                if (res != STATUS_UNSUPPORTED)
+                    return res;
+                return s->stretch(op->nLength, op->nChunkSize, op->enFadeType, op->fCrossfade);
+            }
+
+            static status_t stretch_op(dspu::Sample *s, const void *arg)
+            {
+                const stretch_op_t *op  = static_cast<const stretch_op_t *>(arg);
+
+                status_t res            = sample_stretcher::stretch(s, op->nEngine, op->nLength, op->nStart, op->nEnd, op->pScratch);
+                if (res != STATUS_UNSUPPORTED)
+                    return res;
+                return s->stretch(op->nLength, op->nChunkSize, op->enFadeType, op->fCrossfade, op->nStart, op->nEnd);
+            }
+        } /* namespace */
+
+        //-------------------------------------------------------------------------
+        sampler_kernel::ChannelTask::ChannelTask()
+        {
+            pOp         = NULL;
+            pSample     = NULL;
+            pArg        = NULL;
+        }
+
+        sampler_kernel::ChannelTask::~ChannelTask()
+        {
+            pOp         = NULL;
+            pSample     = NULL;
+            pArg        = NULL;
+        }
+
+        void sampler_kernel::ChannelTask::bind(channel_op_t op, dspu::Sample *s, const void *arg)
+        {
+            pOp         = op;
+            pSample     = s;
+            pArg        = arg;
+        }
+
+        status_t sampler_kernel::ChannelTask::run()
+        {
+            dsp::context_t ctx;
+            dsp::start(&ctx);
+            lsp_finally { dsp::finish(&ctx); };
+
+            return pOp(pSample, pArg);
+        }
+
         //-------------------------------------------------------------------------
         sampler_kernel::AFLoader::AFLoader(sampler_kernel *base, afile_t *descr)
         {
@@ -82,9 +235,74 @@ namespace lsp
             dsp::start(&ctx);
             lsp_finally { dsp::finish(&ctx); };
 
-            return pCore->render_sample(pFile);
+            status_t res = pCore->render_sample(pFile);
+            if (res != STATUS_OK)
+                return res;
+
+            return pCore->render_variants(pFile);
         };
 
+        status_t sampler_kernel::AFRenderer::process_channels(dspu::Sample *s, channel_op_t op, const void *arg)
+        {
+            // Channels are processed in parallel only by the worker threads requested by the user
+            const size_t channels   = s->channels();
+            const size_t length     = s->length();
+            worker_pool *pool       = pCore->pPool;
+            if ((channels <= 1) || (channels > meta::sampler_metadata::TRACKS_MAX) || (length < PARALLEL_RENDER_THRESHOLD) ||
+                (pool == NULL) || (!pool->enabled()))
+                return op(s, arg);
+
+            // Split the sample into mono samples, the memory of the parts is reused by next renders
+            ipc::ITask *tasks[meta::sampler_metadata::TRACKS_MAX];
+            for (size_t i=0; i<channels; ++i)
+            {
+                dspu::Sample *p         = &vParts[i];
+                if ((p->channels() != 1) || (p->max_length() < length))
+                {
+                    if (!p->init(1, length, length))
+                        return STATUS_NO_MEM;
+                }
+                else
+                    p->set_length(length);
+                p->set_sample_rate(s->sample_rate());
+                dsp::copy(p->channel(0), s->channel(i), length);
+
+                ChannelTask *t          = &vTasks[i];
+                if (t->completed())
+                    t->reset();
+                t->bind(op, p, arg);
+                tasks[i]                = t;
+            }
+
+            // Process the channels by the worker threads and the current thread
+            pool->execute_group(tasks, channels, (pCore->bInteractive) ? TASK_INTERACTIVE : TASK_RENDER);
+            for (size_t i=0; i<channels; ++i)
+            {
+                const status_t res      = vTasks[i].code();
+                if (res != STATUS_OK)
+                    return res;
+            }
+
+            // Merge the channels back in the same order, so the result does not depend on the scheduling
+            const size_t out_length = vParts[0].length();
+            for (size_t i=1; i<channels; ++i)
+                if (vParts[i].length() != out_length)
+                    return STATUS_BAD_STATE;
+
+            if (s->max_length() < out_length)
+            {
+                if (!s->init(channels, out_length, out_length))
+                    return STATUS_NO_MEM;
+            }
+            else
+                s->set_length(out_length);
+            s->set_sample_rate(vParts[0].sample_rate());
+            for (size_t i=0; i<channels; ++i)
+                dsp::copy(s->channel(i), vParts[i].channel(0), out_length);
+
+            return STATUS_OK;
+        }
+
         void sampler_kernel::AFRenderer::dump(dspu::IStateDumper *v) const
         {
             v->write("pCore", pCore);
@@ -119,7 +337,18 @@ namespace lsp
             sGCTask(this)
         {
             pExecutor       = NULL;
+            pPool           = NULL;
             pGCList         = NULL;
+            pGCReleased     = NULL;
+            nGCReclaimed    = 0;
+            nTime           = 0;
+            vVoices         = NULL;
+            nVoices         = 0;
+            nPolyphony      = 0;
+            nStealPolicy    = STEAL_DFL;
+            nKeyRange       = 0;
+            bTrackVoices    = false;
+            nLastVoice      = 0;
             vFiles          = NULL;
             vActive         = NULL;
             nFiles          = 0;
@@ -131,6 +360,13 @@ namespace lsp
             bHandleVelocity = true;
             bEnvelopeEdit   = false;
             fFadeout        = 10.0f;
+            fRenderSettle   = meta::sampler_metadata::RENDER_SETTLE_DFL;
+            fRenderInterval = meta::sampler_metadata::RENDER_INTERVAL_DFL;
+            nResampleQuality = RESAMPLE_DFL;
+            nStretchEngine  = STRETCH_DFL;
+            bLoopBake       = false;
+            bHotSwap        = false;
+            bInteractive    = false;
             fDynamics       = meta::sampler_metadata::DYNA_DFL;
             fDrift          = meta::sampler_metadata::DRIFT_DFL;
             nSampleRate     = 0;
@@ -138,6 +374,9 @@ namespace lsp
             pDynamics       = NULL;
             pHandleVelocity = NULL;
             pDrift          = NULL;
+            pPolyphony      = NULL;
+            pStealPolicy    = NULL;
+            pKeyRange       = NULL;
             pSampleSel      = NULL;
             pActivity       = NULL;
             pListen         = NULL;
@@ -161,7 +400,64 @@ namespace lsp
             bEnvelopeEdit       = edit;
         }
 
-        bool sampler_kernel::init(ipc::IExecutor *executor, size_t files, size_t channels)
+        void sampler_kernel::set_render_timing(float settle, float interval)
+        {
+            fRenderSettle       = lsp_limit(settle, meta::sampler_metadata::RENDER_SETTLE_MIN, meta::sampler_metadata::RENDER_SETTLE_MAX);
+            fRenderInterval     = lsp_limit(interval, meta::sampler_metadata::RENDER_INTERVAL_MIN, meta::sampler_metadata::RENDER_INTERVAL_MAX);
+        }
+
+        void sampler_kernel::set_resample_quality(size_t quality)
+        {
+            quality             = lsp_min(quality, size_t(RESAMPLE_MASTERING));
+            if (nResampleQuality == quality)
+                return;
+
+            // All files need to be re-rendered with the new quality
+            nResampleQuality    = quality;
+            for (size_t i=0; i<nFiles; ++i)
+                ++vFiles[i].nUpdateReq;
+        }
+
+        void sampler_kernel::set_stretch_engine(size_t engine)
+        {
+            engine              = lsp_min(engine, size_t(STRETCH_WSOLA));
+            if (nStretchEngine == engine)
+                return;
+
+            // All files need to be re-rendered with the new engine
+            nStretchEngine      = engine;
+            for (size_t i=0; i<nFiles; ++i)
+                ++vFiles[i].nUpdateReq;
+        }
+
+        void sampler_kernel::set_loop_bake(bool bake)
+        {
+            if (bLoopBake == bake)
+                return;
+
+            // All files need to be re-rendered
+            bLoopBake           = bake;
+            for (size_t i=0; i<nFiles; ++i)
+                ++vFiles[i].nUpdateReq;
+        }
+
+        void sampler_kernel::set_hot_swap(bool hot_swap)
+        {
+            // The re-render is not required, the setting is applied to the next swap
+            bHotSwap            = hot_swap;
+        }
+
+        void sampler_kernel::set_interactive(bool interactive)
+        {
+            bInteractive        = interactive;
+        }
+
+        void sampler_kernel::set_voice_tracking(bool track)
+        {
+            bTrackVoices        = track;
+        }
+
+        bool sampler_kernel::init(ipc::IExecutor *executor, worker_pool *pool, size_t files, size_t channels)
         {
             // Validate parameters
             channels        = lsp_min(channels, meta::sampler_metadata::TRACKS_MAX);
@@ -171,15 +467,22 @@ namespace lsp
             nChannels       = channels;
             bReorder        = true;
             nActive         = 0;
+            nTime           = 0;
             pExecutor       = executor;
+            pPool           = pool;
+
+            // Initialize the queue of delayed triggers
+            if (!sEvents.init(meta::sampler_metadata::EVENTS_MAX))
+                return false;
 
             // Now determine object sizes
             size_t afile_szof           = align_size(sizeof(afile_t) * files, DEFAULT_ALIGN);
             size_t vactive_szof         = align_size(sizeof(afile_t *) * files, DEFAULT_ALIGN);
             size_t vbuffer_szof         = align_size(sizeof(float) * meta::sampler_metadata::BUFFER_SIZE, DEFAULT_ALIGN);
+            size_t voices_szof          = align_size(sizeof(voice_t) * meta::sampler_metadata::TOTAL_VOICES_MAX, DEFAULT_ALIGN);
 
             // Allocate raw chunk and link data
-            size_t allocate             = afile_szof + vactive_szof + vbuffer_szof;
+            size_t allocate             = afile_szof + vactive_szof + vbuffer_szof + voices_szof;
             uint8_t *ptr                = alloc_aligned<uint8_t>(pData, allocate);
             if (ptr == NULL)
                 return false;
@@ -191,6 +494,21 @@ namespace lsp
             vFiles                      = advance_ptr_bytes<afile_t>(ptr, afile_szof);
             vActive                     = advance_ptr_bytes<afile_t *>(ptr, vactive_szof);
             vBuffer                     = advance_ptr_bytes<float>(ptr, vbuffer_szof);
+            vVoices                     = advance_ptr_bytes<voice_t>(ptr, voices_szof);
+            nVoices                     = 0;
+            nLastVoice                  = 0;
+
+            for (size_t i=0; i<meta::sampler_metadata::TOTAL_VOICES_MAX; ++i)
+            {
+                voice_t *v                  = &vVoices[i];
+                for (size_t j=0; j<4; ++j)
+                    v->vPlayback[j].construct();
+                v->nStart                   = 0;
+                v->nFile                    = 0;
+                v->nKey                     = 0;
+                v->fGain                    = 0.0f;
+                v->bReleased                = false;
+            }
 
             for (size_t i=0; i<files; ++i)
             {
@@ -208,21 +526,39 @@ namespace lsp
                     af->vPlayback[i].construct();
                     af->vListen[i].construct();
                 }
+                for (size_t j=0; j<KEY_VARIANTS; ++j)
+                {
+                    for (size_t i=0; i<4; ++i)
+                        af->vKeyPlayback[j][i].construct();
+                    af->vVariants[j]            = NULL;
+                }
                 af->pOriginal               = NULL;
                 af->pProcessed              = NULL;
+                af->pPartial                = NULL;
                 for (size_t j=0; j<meta::sampler_metadata::TRACKS_MAX; ++j)
                 {
                     af->vThumbs[j]              = NULL;
                     af->vCutThumbs[j]           = NULL;
+                    af->vDraftThumbs[j]         = NULL;
+                    af->vDraftCutThumbs[j]      = NULL;
                 }
+                af->sSourceStage.pSample    = NULL;
+                af->sStretchStage.pSample   = NULL;
+                af->sCutStage.pSample       = NULL;
+                drop_render_stage(&af->sSourceStage);
+                drop_render_stage(&af->sStretchStage);
+                drop_render_stage(&af->sCutStage);
 
                 af->sListen.init();
                 af->sStop.init();
 
                 af->nUpdateReq              = 0;
                 af->nUpdateResp             = 0;
+                af->nRenderSettle           = 0;
+                af->nRenderHold             = 0;
                 af->bEnvEdit                = false;
                 af->bSync                   = false;
+                af->bDraftSync              = false;
                 af->fMinVelocity            = 1.0f;
                 af->fMaxVelocity            = 1.0f;
                 af->fPitch                  = 0.0f;
@@ -233,6 +569,7 @@ namespace lsp
                 af->fStretchChunk           = 0.0f;
                 af->fStretchFade            = 0.0f;
                 af->nStretchFadeType        = XFADE_DFL;
+                af->fStretchRate            = 0.0f;
                 af->enLoopMode              = dspu::SAMPLE_LOOP_NONE;
                 af->fLoopStart              = 0.0f;
                 af->fLoopEnd                = 0.0f;
@@ -373,11 +710,12 @@ namespace lsp
                 }
             }
 
-            // Initialize channels
+            // Initialize channels, each file occupies one sample slot for the base sample
+            // and one sample slot for each pitch variant
             lsp_trace("Initialize channels");
             for (size_t i=0; i<nChannels; ++i)
             {
-                if (!vChannels[i].init(nFiles, meta::sampler_metadata::PLAYBACKS_MAX))
+                if (!vChannels[i].init(nFiles * (KEY_VARIANTS + 1), meta::sampler_metadata::PLAYBACKS_MAX))
                 {
                     destroy_state();
                     return false;
@@ -403,6 +741,9 @@ namespace lsp
                 BIND_PORT(pDynamics);
                 BIND_PORT(pDrift);
                 BIND_PORT(pHandleVelocity);
+                BIND_PORT(pPolyphony);
+                BIND_PORT(pStealPolicy);
+                BIND_PORT(pKeyRange);
             }
 
             lsp_trace("Skipping sample selector port...");
@@ -514,6 +855,51 @@ namespace lsp
             sample  = NULL;
         }
 
+        void sampler_kernel::release_sample(dspu::Sample * &sample)
+        {
+            if (sample == NULL)
+                return;
+
+            // Shared samples are controlled by the reference counter
+            if (is_shared_sample(sample))
+            {
+                if (sample->gc_release() == 0)
+                    destroy_sample(sample);
+                sample  = NULL;
+                return;
+            }
+
+            destroy_sample(sample);
+        }
+
+        bool sampler_kernel::is_shared_sample(const dspu::Sample *sample)
+        {
+            // The sample without render parameters is the original sample or the result
+            // of the render stage, both are shared
+            const render_params_t *rp = static_cast<const render_params_t *>(sample->user_data());
+            return (rp == NULL) || (rp->bShared);
+        }
+
+        void sampler_kernel::drop_render_stage(render_stage_t *stage)
+        {
+            // The result of the stage may still be used for playback
+            release_sample(stage->pSample);
+            stage->nHash            = 0;
+            stage->sParams.nLength          = 0;
+            stage->sParams.nHeadCut         = 0;
+            stage->sParams.nTailCut         = 0;
+            stage->sParams.nCutLength       = 0;
+            stage->sParams.nStretchDelta    = 0;
+            stage->sParams.nStretchStart    = 0;
+            stage->sParams.nStretchEnd      = 0;
+            stage->sParams.nLoopStart       = 0;
+            stage->sParams.nLoopEnd         = 0;
+            stage->sParams.nLoopFade        = 0;
+            stage->sParams.bShared          = false;
+            stage->sParams.bReversed        = false;
+            stage->sParams.bDraft           = false;
+        }
+
         void sampler_kernel::destroy_afile(afile_t *af)
         {
             af->sListen.destroy();
@@ -524,6 +910,11 @@ namespace lsp
                 af->vPlayback[i].destroy();
                 af->vListen[i].destroy();
             }
+            for (size_t j=0; j<KEY_VARIANTS; ++j)
+            {
+                for (size_t i=0; i<4; ++i)
+                    af->vKeyPlayback[j][i].destroy();
+            }
 
             // Delete audio file loader
             if (af->pLoader != NULL)
@@ -557,11 +948,52 @@ namespace lsp
             }
         }
 
+        size_t sampler_kernel::sample_bytes(const dspu::Sample *s)
+        {
+            return s->max_length() * s->channels() * sizeof(float);
+        }
+
+        void sampler_kernel::release_heap_memory()
+        {
+        #ifdef __GLIBC__
+            // Return free pages of the heap back to the system
+            malloc_trim(0);
+        #endif /* __GLIBC__ */
+        }
+
+        void sampler_kernel::update_stretch_rate(afile_t *af, size_t samples, wssize_t started)
+        {
+            const wssize_t elapsed  = lsp_max(system::get_time_millis() - started, wssize_t(1));
+            af->fStretchRate        = float(samples) * 1000.0f / float(elapsed);
+            lsp_trace("Stretched %ld samples in %ld ms, rate=%.0f samples/s",
+                long(samples), long(elapsed), af->fStretchRate);
+        }
+
         void sampler_kernel::perform_gc()
         {
             dspu::Sample *gc_list = lsp::atomic_swap(&pGCList, NULL);
             lsp_trace("gc_list = %p", gc_list);
-            destroy_samples(gc_list);
+
+            // Destroy samples in bounded slices to not to block the executor for a long time
+            size_t reclaimed    = 0;
+            while ((gc_list != NULL) && (reclaimed < GC_SLICE_BYTES))
+            {
+                dspu::Sample *next  = gc_list->gc_next();
+                reclaimed          += sample_bytes(gc_list);
+                destroy_sample(gc_list);
+                gc_list             = next;
+            }
+
+            // The rest of the list will be processed by the next run
+            pGCList             = gc_list;
+            nGCReclaimed       += reclaimed;
+            if (reclaimed >= GC_TRIM_THRESHOLD)
+                release_heap_memory();
+
+            if (reclaimed > 0)
+                lsp_info("Garbage collector reclaimed %ld bytes, %ld bytes total",
+                    long(reclaimed), long(nGCReclaimed));
+            lsp_trace("pending gc_list = %p", gc_list);
         }
 
         void sampler_kernel::destroy_state()
@@ -582,16 +1014,36 @@ namespace lsp
             }
 
             // Perform pending gabrage collection
-            perform_gc();
+            destroy_samples(pGCReleased);
+            pGCReleased     = NULL;
+            do
+            {
+                perform_gc();
+            } while (pGCList != NULL);
+
+            // Forget tracked voices
+            if (vVoices != NULL)
+            {
+                for (size_t i=0; i<meta::sampler_metadata::TOTAL_VOICES_MAX; ++i)
+                {
+                    for (size_t j=0; j<4; ++j)
+                        vVoices[i].vPlayback[j].destroy();
+                }
+            }
 
             // Drop all preallocated data
             free_aligned(pData);
+            sScratch.destroy();
+            sEvents.destroy();
 
             // Foget variables
             vFiles          = NULL;
             vActive         = NULL;
             vBuffer         = NULL;
+            vVoices         = NULL;
+            nVoices         = 0;
             pExecutor       = NULL;
+            pPool           = NULL;
             nFiles          = 0;
             nChannels       = 0;
             bReorder        = false;
@@ -600,6 +1052,9 @@ namespace lsp
             pDynamics       = NULL;
             pHandleVelocity = NULL;
             pDrift          = NULL;
+            pPolyphony      = NULL;
+            pStealPolicy    = NULL;
+            pKeyRange       = NULL;
             pSampleSel      = NULL;
         }
 
@@ -748,7 +1203,12 @@ namespace lsp
                 commit_value(loop_update, af->fLoopFade, af->pLoopFade);
                 commit_value(loop_update, af->nLoopFadeType, af->pLoopFadeType);
 
-                if ((loop_update > 0) || (upd_req != af->nUpdateReq))
+                // Loop cross-fades baked into the sample require the sample to be re-rendered
+                if ((loop_update > 0) && (bLoopBake))
+                    ++af->nUpdateReq;
+
+                // Voices keep playing the previous sample until they end if hot-swap is enabled
+                if ((!bHotSwap) && ((loop_update > 0) || (upd_req != af->nUpdateReq)))
                     cancel_sample(af, 0);
 
                 // Update envelope settings
@@ -780,6 +1240,10 @@ namespace lsp
                     }
                 }
 
+                // Postpone the render until parameters settle
+                if (upd_req != af->nUpdateReq)
+                    af->nRenderSettle   = dspu::millis_to_samples(nSampleRate, fRenderSettle);
+
                 // Update envelope view
                 const bool env_edit = (i == active_file) && bEnvelopeEdit;
                 if (env_edit != af->bEnvEdit)
@@ -793,6 +1257,28 @@ namespace lsp
             fDynamics       = (pDynamics != NULL) ? pDynamics->value() * 0.01f : 0.0f; // fDynamics = 0..1.0
             fDrift          = (pDrift != NULL)    ? pDrift->value() : 0.0f;
             bHandleVelocity = pHandleVelocity->value() >= 0.5f;
+
+            // Get polyphony limit, the list of limits contains powers of two
+            const size_t poly   = (pPolyphony != NULL) ? size_t(pPolyphony->value()) : 0;
+            nPolyphony      = (poly > 0) ? lsp_min(size_t(1) << (poly - 1), meta::sampler_metadata::VOICES_MAX) : 0;
+            nStealPolicy    = (pStealPolicy != NULL) ? size_t(pStealPolicy->value()) : STEAL_DFL;
+            if ((nPolyphony <= 0) && (!bTrackVoices))
+                drop_voices();
+
+            // Get key range, all files need to be re-rendered with the new set of pitch variants
+            const size_t key_range  = (pKeyRange != NULL) ?
+                lsp_min(size_t(pKeyRange->value()), meta::sampler_metadata::KEY_RANGE_MAX) : 0;
+            if (key_range != nKeyRange)
+            {
+                // Playbacks of the keys out of the new range can not be stopped by the note-off anymore
+                for (size_t i=0; i<nFiles; ++i)
+                {
+                    afile_t *af         = &vFiles[i];
+                    cancel_variants(af, 0);
+                    ++af->nUpdateReq;
+                }
+                nKeyRange       = key_range;
+            }
         }
 
         void sampler_kernel::sync_samples_with_ui()
@@ -819,9 +1305,15 @@ namespace lsp
 
         void sampler_kernel::unload_afile(afile_t *af)
         {
-            // Destroy original sample if present
-            destroy_sample(af->pOriginal);
-            destroy_sample(af->pProcessed);
+            // Release original sample if present, it may still be used for playback
+            release_sample(af->pOriginal);
+            release_sample(af->pProcessed);
+            release_variants(af);
+
+            // Drop cached results of render stages
+            drop_render_stage(&af->sSourceStage);
+            drop_render_stage(&af->sStretchStage);
+            drop_render_stage(&af->sCutStage);
 
             // Destroy pointer to thumbnails
             if (af->vThumbs[0])
@@ -831,7 +1323,10 @@ namespace lsp
             {
                 af->vThumbs[i]              = NULL;
                 af->vCutThumbs[i]           = NULL;
+                af->vDraftThumbs[i]         = NULL;
+                af->vDraftCutThumbs[i]      = NULL;
             }
+            af->bDraftSync  = false;
         }
 
         status_t sampler_kernel::load_file(afile_t *file)
@@ -855,30 +1350,17 @@ namespace lsp
             if (strlen(fname) <= 0)
                 return STATUS_UNSPECIFIED;
 
-            // Load audio file
-            dspu::Sample *source    = new dspu::Sample();
-            if (source == NULL)
-                return STATUS_NO_MEM;
-            lsp_trace("Allocated sample %p", source);
-            lsp_finally { destroy_sample(source); };
-
-            // Load sample
-            status_t status = source->load_ext(fname, meta::sampler_metadata::SAMPLE_LENGTH_MAX * 0.001f);
+            // Decode the audio file
+            dspu::Sample *source    = NULL;
+            status_t status         = decode_original(source, fname);
             if (status != STATUS_OK)
-            {
-                lsp_trace("load failed: status=%d (%s)", status, get_status(status));
                 return status;
-            }
-            const size_t channels   = lsp_min(nChannels, source->channels());
-            if (!source->set_channels(channels))
-            {
-                lsp_trace("failed to resize source sample to %d channels", int(channels));
-                return status;
-            }
+            lsp_finally { release_sample(source); };
+            const size_t channels   = source->channels();
 
             // Initialize thumbnails
             float *thumbs           = static_cast<float *>(malloc(
-                sizeof(float) * channels * meta::sampler_metadata::MESH_SIZE * 2));
+                sizeof(float) * channels * meta::sampler_metadata::MESH_SIZE * 4));
             if (thumbs == NULL)
                 return STATUS_NO_MEM;
 
@@ -886,6 +1368,8 @@ namespace lsp
             {
                 file->vThumbs[i]        = advance_ptr<float>(thumbs, meta::sampler_metadata::MESH_SIZE);
                 file->vCutThumbs[i]     = advance_ptr<float>(thumbs, meta::sampler_metadata::MESH_SIZE);
+                file->vDraftThumbs[i]   = advance_ptr<float>(thumbs, meta::sampler_metadata::MESH_SIZE);
+                file->vDraftCutThumbs[i]= advance_ptr<float>(thumbs, meta::sampler_metadata::MESH_SIZE);
             }
 
             // Commit the result
@@ -895,239 +1379,1248 @@ namespace lsp
             return STATUS_OK;
         }
 
-        status_t sampler_kernel::render_sample(afile_t *af)
+        void sampler_kernel::advise_sample_memory(dspu::Sample *s)
         {
-            status_t res;
+        #if defined(PLATFORM_LINUX) && defined(MADV_HUGEPAGE)
+            if ((s == NULL) || (s->channels() <= 0))
+                return;
 
-            // Validate arguments
-            if (af == NULL)
-                return STATUS_UNKNOWN_ERR;
+            // All channels of the sample are stored in a single contiguous buffer
+            const size_t bytes      = sample_bytes(s);
+            if (bytes < HUGE_PAGE_THRESHOLD)
+                return;
 
-            // Get maximum sample count
-            dspu::Sample *src       = af->pOriginal;
-            if (src == NULL)
-                return STATUS_UNSPECIFIED;
+            // Only whole pages inside of the buffer can be advised
+            const uintptr_t page    = sysconf(_SC_PAGESIZE);
+            const uintptr_t head    = uintptr_t(s->channel(0));
+            const uintptr_t first   = (head + page - 1) & ~(page - 1);
+            const uintptr_t last    = (head + bytes) & ~(page - 1);
+            if (first >= last)
+                return;
 
-            // Copy data of original sample to temporary sample and perform resampling
-            dspu::Sample temp;
-            size_t channels         = lsp_min(nChannels, src->channels());
-            size_t sample_rate_dst  = nSampleRate * dspu::semitones_to_frequency_shift(-af->fPitch);
-            if (temp.copy(src) != STATUS_OK)
-            {
-                lsp_warn("Error copying source sample");
+            if (madvise(reinterpret_cast<void *>(first), last - first, MADV_HUGEPAGE) != 0)
+                lsp_trace("madvise(MADV_HUGEPAGE) failed for sample %p", s);
+        #endif /* PLATFORM_LINUX */
+        }
+
+        status_t sampler_kernel::decode_original(dspu::Sample * &dst, const char *fname)
+        {
+            // Load audio file
+            dspu::Sample *source    = new dspu::Sample();
+            if (source == NULL)
                 return STATUS_NO_MEM;
+            lsp_trace("Allocated sample %p", source);
+            lsp_finally { destroy_sample(source); };
+
+            // Decode sample directly into the target sample. If the file can not be decoded as
+            // a stream (for example, it is stored inside of the resource bundle), load it in a usual way
+            status_t status = decode_file(source, fname);
+            if (status == STATUS_NO_MEM)
+                return status;
+            else if (status != STATUS_OK)
+            {
+                lsp_trace("stream decode failed: status=%d (%s), falling back to full load", status, get_status(status));
+                status = source->load_ext(fname, meta::sampler_metadata::SAMPLE_LENGTH_MAX * 0.001f);
             }
-            if (temp.resample(sample_rate_dst) != STATUS_OK)
+            if (status != STATUS_OK)
             {
-                lsp_warn("Error resampling source sample");
-                return STATUS_NO_MEM;
+                lsp_trace("load failed: status=%d (%s)", status, get_status(status));
+                return status;
             }
-            if (af->bPreReverse)
-                temp.reverse();
-
-            if (af->bCompensate)
+            const size_t channels   = lsp_min(nChannels, source->channels());
+            if (!source->set_channels(channels))
             {
-                size_t chunk_size       = dspu::millis_to_samples(nSampleRate, af->fCompensateChunk);
-                dspu::sample_crossfade_t fade_type  = (af->nCompensateFadeType == XFADE_LINEAR) ?
-                    dspu::SAMPLE_CROSSFADE_LINEAR :
-                    dspu::SAMPLE_CROSSFADE_CONST_POWER;
-                float crossfade         = lsp_limit(af->fCompensateFade * 0.01f, 0.0f, 1.0f);
-
-                if ((res = temp.stretch(src->length(), chunk_size, fade_type, crossfade)) != STATUS_OK)
-                    return res;
+                lsp_trace("failed to resize source sample to %d channels", int(channels));
+                return STATUS_NO_MEM;
             }
 
-            af->fLength             = dspu::samples_to_millis(nSampleRate, temp.length());
+            // The original sample is reference-counted, other references may be held by the
+            // sample players when the sample is used for playback without processing
+            source->gc_acquire();
+            lsp::swap(dst, source);
 
-            // Allocate target sample
-            dspu::Sample *out   = new dspu::Sample();
-            if (out == NULL)
+            return STATUS_OK;
+        }
+
+        status_t sampler_kernel::decode_file(dspu::Sample *dst, const char *fname)
+        {
+            mm::InAudioFileStream is;
+            status_t res = is.open(fname);
+            if (res != STATUS_OK)
+                return res;
+            lsp_finally { is.close(); };
+
+            mm::audio_stream_t info;
+            if ((res = is.info(&info)) != STATUS_OK)
+                return res;
+            if ((info.channels <= 0) || (info.frames < 0))
+                return STATUS_UNSUPPORTED_FORMAT;
+
+            // Allocate the sample of the final size, decoding will be performed directly into it
+            const size_t max_frames = dspu::millis_to_samples(info.srate, meta::sampler_metadata::SAMPLE_LENGTH_MAX);
+            const size_t frames     = lsp_min(size_t(info.frames), max_frames);
+            const size_t channels   = lsp_min(nChannels, info.channels);
+            if (!dst->init(channels, frames, frames))
                 return STATUS_NO_MEM;
-            lsp_trace("Allocated sample %p", out);
-            lsp_finally { destroy_sample(out); };
-            out->set_sample_rate(nSampleRate);
+            dst->set_sample_rate(info.srate);
+            advise_sample_memory(dst);
 
-            // Allocate user data and bind to the sample
-            render_params_t *rp     = new render_params_t;
-            if (rp == NULL)
+            return decode_region(dst, &is, info.channels, 0, frames);
+        }
+
+        status_t sampler_kernel::decode_region(dspu::Sample *dst, mm::IInAudioStream *is, size_t stream_channels, size_t offset, size_t count)
+        {
+            if (offset > dst->length())
+                return STATUS_OVERFLOW;
+            count                   = lsp_min(count, dst->length() - offset);
+
+            // Position the stream at the beginning of the region
+            if (offset > 0)
+            {
+                const wssize_t pos      = is->seek(offset);
+                if (pos < 0)
+                    return status_t(-pos);
+            }
+
+            // Allocate buffer for one block of interleaved frames
+            uint8_t *data           = NULL;
+            float *buf              = alloc_aligned<float>(data, meta::sampler_metadata::BUFFER_SIZE * stream_channels);
+            if (buf == NULL)
                 return STATUS_NO_MEM;
-            rp->nHeadCut            = 0;
-            rp->nTailCut            = 0;
-            rp->nCutLength          = 0;
-            rp->nStretchDelta       = 0;
-            rp->nStretchStart       = 0;
-            rp->nStretchEnd         = 0;
-            out->set_user_data(rp);
+            lsp_finally { free_aligned(data); };
 
-            // Perform stretch of the sample
-            rp->nStretchDelta       = (af->bStretchOn) ? dspu::millis_to_samples(nSampleRate, af->fStretch) : 0.0f;
-            if (rp->nStretchDelta != 0)
+            // Decode data block by block and de-interleave it into the sample's channels
+            const size_t channels   = lsp_min(dst->channels(), stream_channels);
+            size_t done             = 0;
+            while (done < count)
             {
-                rp->nStretchStart       = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchStart), 0, temp.length());
-                rp->nStretchEnd         = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchEnd), 0, temp.length());
-                if (rp->nStretchStart <= rp->nStretchEnd)
+                const size_t to_read    = lsp_min(count - done, meta::sampler_metadata::BUFFER_SIZE);
+                const ssize_t nread     = is->read(buf, to_read);
+                if (nread < 0)
                 {
-                    ssize_t s_length        = lsp_max(rp->nStretchEnd + rp->nStretchDelta - rp->nStretchStart, 0);
-                    size_t chunk_size       = dspu::millis_to_samples(nSampleRate, af->fStretchChunk);
-                    dspu::sample_crossfade_t fade_type  = (af->nStretchFadeType == XFADE_LINEAR) ?
-                        dspu::SAMPLE_CROSSFADE_LINEAR :
-                        dspu::SAMPLE_CROSSFADE_CONST_POWER;
-                    float crossfade         = lsp_limit(af->fStretchFade * 0.01f, 0.0f, 1.0f);
-
-                    // Perform stretch only when it is possible, do not report errors if stretch didn't succeed
-                    res = temp.stretch(s_length, chunk_size, fade_type, crossfade, rp->nStretchStart, rp->nStretchEnd);
-                    if (res != STATUS_OK)
-                    {
-                        lsp_trace("Failed to stretch sample: %d", int(res));
-                        rp->nStretchDelta       = 0;
-                    }
+                    if (nread == -STATUS_EOF)
+                        break;
+                    return status_t(-nread);
                 }
-                else
+                else if (nread == 0)
+                    break;
+
+                for (size_t j=0; j<channels; ++j)
                 {
-                    rp->nStretchStart   = -1;
-                    rp->nStretchEnd     = -1;
+                    float *dptr             = dst->channel(j, offset + done);
+                    const float *sptr       = &buf[j];
+                    for (ssize_t k=0; k<nread; ++k, sptr += stream_channels)
+                        dptr[k]                 = *sptr;
                 }
-            }
 
-            // Compute the tail and head cut positions
-            rp->nLength         = temp.length();
-            af->fActualLength   = dspu::samples_to_millis(nSampleRate, rp->nLength);
-            rp->nHeadCut        = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fHeadCut), 0, rp->nLength);
-            rp->nTailCut        = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fTailCut), 0, rp->nLength);
-            rp->nCutLength      = lsp_max(rp->nLength - rp->nTailCut - rp->nHeadCut, 0);
-
-            // Determine the normalizing factor
-            float abs_max           = 0.0f;
-            for (size_t i=0; i<channels; ++i)
-                abs_max                 = lsp_max(abs_max, dsp::abs_max(temp.channel(i), rp->nLength));
-            const float norming     = (abs_max != 0.0f) ? 1.0f / abs_max : 1.0f;
+                done                   += nread;
+            }
 
-            // Apply the fade-in and fade-out
-            ssize_t fade_in     = dspu::millis_to_samples(nSampleRate, af->fFadeIn);
-            ssize_t fade_out    = dspu::millis_to_samples(nSampleRate, af->fFadeOut);
-            for (size_t j=0; j<channels; ++j)
+            // Stream may be shorter than declared, clear the rest of the region
+            if (done < count)
             {
-                float *dst          = temp.channel(j);
-
-                dspu::fade_in(&dst[rp->nHeadCut], &dst[rp->nHeadCut], fade_in, rp->nLength - rp->nHeadCut);
-                dspu::fade_out(dst, dst, fade_out, rp->nLength - rp->nTailCut);
+                for (size_t j=0; j<channels; ++j)
+                    dsp::fill_zero(dst->channel(j, offset + done), count - done);
             }
 
-            // Determine the normalizing factor for cut sample
-            abs_max                 = 0.0f;
-            for (size_t i=0; i<channels; ++i)
-                abs_max                 = lsp_max(abs_max, dsp::abs_max(temp.channel(i, rp->nHeadCut), rp->nCutLength));
-            const float cut_norming = (abs_max != 0.0f) ? 1.0f / abs_max : 1.0f;
+            return STATUS_OK;
+        }
 
-            // Apply envelope if it is enabled
+        void sampler_kernel::render_thumbnails(float *dst, const float *src, size_t length)
+        {
+            const float scaling     = float(length) / meta::sampler_metadata::MESH_SIZE;
+
+            for (size_t k=0; k<meta::sampler_metadata::MESH_SIZE; ++k)
+            {
+                const size_t first  = k * scaling;
+                const size_t last   = (k + 1) * scaling;
+                if (first < last)
+                    dst[k]              = dsp::abs_max(&src[first], last - first);
+                else if (first < length)
+                    dst[k]              = fabs(src[first]);
+                else
+                    dst[k]              = 0.0f;
+            }
+        }
+
+        void sampler_kernel::render_composite_thumbnails(float *dst, const float *src, const float *cut, const render_params_t *rp)
+        {
+            const ssize_t length    = rp->nLength;
+            const ssize_t cut_start = rp->nHeadCut;
+            const ssize_t cut_end   = rp->nHeadCut + rp->nCutLength;
+            const float scaling     = float(length) / meta::sampler_metadata::MESH_SIZE;
+
+            // The data outside of the cut region is taken from the source, inside from the cut sample
+            for (size_t k=0; k<meta::sampler_metadata::MESH_SIZE; ++k)
+            {
+                const ssize_t first = k * scaling;
+                ssize_t last        = (k + 1) * scaling;
+                if (first >= last)
+                {
+                    if (first >= length)
+                    {
+                        dst[k]              = 0.0f;
+                        continue;
+                    }
+                    last                = first + 1;
+                }
+
+                float v             = 0.0f;
+                if (first < cut_start)
+                    v                   = lsp_max(v, range_abs_max(src, length, first, lsp_min(last, cut_start) - first, rp->bReversed));
+
+                ssize_t lo          = lsp_max(first, cut_start);
+                ssize_t hi          = lsp_min(last, cut_end);
+                if (lo < hi)
+                    v                   = lsp_max(v, dsp::abs_max(&cut[lo - cut_start], hi - lo));
+
+                lo                  = lsp_max(first, cut_end);
+                if (lo < last)
+                    v                   = lsp_max(v, range_abs_max(src, length, lo, last - lo, rp->bReversed));
+
+                dst[k]              = v;
+            }
+        }
+
+        void sampler_kernel::analyze_sample(float *thumbs, float *cut_thumbs, const float *src, const float *cut, const render_params_t *rp)
+        {
+            const ssize_t mesh_size = meta::sampler_metadata::MESH_SIZE;
+            const ssize_t length    = rp->nLength;
+            const ssize_t cut_start = rp->nHeadCut;
+            const ssize_t cut_end   = rp->nHeadCut + rp->nCutLength;
+
+            // Buckets of short samples overlap, they can not be computed in a single pass
+            if ((length < mesh_size) || (rp->nCutLength < mesh_size))
+            {
+                render_composite_thumbnails(thumbs, src, cut, rp);
+                render_thumbnails(cut_thumbs, cut, rp->nCutLength);
+                return;
+            }
+
+            const float scaling     = float(length) / mesh_size;
+            const float cut_scaling = float(rp->nCutLength) / mesh_size;
+            dsp::fill_zero(cut_thumbs, mesh_size);
+
+            // Walk the data once, each segment between the boundaries of full and cut buckets
+            // contributes to the full bucket and to the cut bucket if it is inside of the cut region
+            ssize_t ck              = 0;
+            ssize_t c_last          = cut_start + ssize_t(cut_scaling);
+            for (ssize_t k=0; k<mesh_size; ++k)
+            {
+                const ssize_t first = k * scaling;
+                const ssize_t last  = (k + 1) * scaling;
+
+                float v             = 0.0f;
+                if (first < cut_start)
+                    v                   = lsp_max(v, range_abs_max(src, length, first, lsp_min(last, cut_start) - first, rp->bReversed));
+
+                ssize_t lo          = lsp_max(first, cut_start);
+                const ssize_t hi    = lsp_min(last, cut_end);
+                while (lo < hi)
+                {
+                    const ssize_t seg   = (ck < mesh_size) ? lsp_min(hi, c_last) : hi;
+                    const float m       = dsp::abs_max(&cut[lo - cut_start], seg - lo);
+                    v                   = lsp_max(v, m);
+                    if (ck < mesh_size)
+                        cut_thumbs[ck]      = lsp_max(cut_thumbs[ck], m);
+
+                    lo                  = seg;
+                    if ((ck < mesh_size) && (lo >= c_last))
+                    {
+                        ++ck;
+                        c_last              = cut_start + ssize_t((ck + 1) * cut_scaling);
+                    }
+                }
+
+                lo                  = lsp_max(first, cut_end);
+                if (lo < last)
+                    v                   = lsp_max(v, range_abs_max(src, length, lo, last - lo, rp->bReversed));
+
+                thumbs[k]           = v;
+            }
+        }
+
+        void sampler_kernel::normalize_thumbnails(float * const *thumbs, size_t channels)
+        {
+            // Normalize graphs to the peak of the displayed data
+            float peak              = 0.0f;
+            for (size_t j=0; j<channels; ++j)
+                peak                    = lsp_max(peak, dsp::max(thumbs[j], meta::sampler_metadata::MESH_SIZE));
+            if ((peak == 0.0f) || (peak == 1.0f))
+                return;
+
+            const float norming     = 1.0f / peak;
+            for (size_t j=0; j<channels; ++j)
+                dsp::mul_k2(thumbs[j], norming, meta::sampler_metadata::MESH_SIZE);
+        }
+
+        bool sampler_kernel::is_identity_render(const afile_t *af, const dspu::Sample *src) const
+        {
+            if (src->sample_rate() != nSampleRate)
+                return false;
+            if ((af->fPitch != 0.0f) || (af->bPreReverse) || (af->bCompensate) || (af->bEnvelopeOn))
+                return false;
+            if (is_loop_baked(af))
+                return false;
+            if ((af->bStretchOn) && (dspu::millis_to_samples(nSampleRate, af->fStretch) != 0))
+                return false;
+
+            return
+                (dspu::millis_to_samples(nSampleRate, af->fHeadCut) <= 0) &&
+                (dspu::millis_to_samples(nSampleRate, af->fTailCut) <= 0) &&
+                (dspu::millis_to_samples(nSampleRate, af->fFadeIn) <= 0) &&
+                (dspu::millis_to_samples(nSampleRate, af->fFadeOut) <= 0);
+        }
+
+        status_t sampler_kernel::render_identity(afile_t *af, dspu::Sample *src)
+        {
+            const size_t channels   = lsp_min(nChannels, src->channels());
+            const size_t length     = src->length();
+
+            af->fLength             = dspu::samples_to_millis(nSampleRate, length);
+            af->fActualLength       = af->fLength;
+
+            // Only thumbnails need to be computed, the full and cut ones are the same
+            for (size_t j=0; j<channels; ++j)
+            {
+                render_thumbnails(af->vThumbs[j], src->channel(j), length);
+                dsp::copy(af->vCutThumbs[j], af->vThumbs[j], meta::sampler_metadata::MESH_SIZE);
+            }
+            normalize_thumbnails(af->vThumbs, channels);
+            normalize_thumbnails(af->vCutThumbs, channels);
+
+            // Processed sample shares the data with the original sample
+            dspu::Sample *out       = src;
+            out->gc_acquire();
+            lsp::swap(out, af->pProcessed);
+            release_sample(out);
+
+            return STATUS_OK;
+        }
+
+        void sampler_kernel::configure_envelope(dspu::ADSREnvelope *e, const afile_t *af)
+        {
+            e->set_attack(
+                af->fEnvelopeAttackTime * 0.01f,
+                af->fEnvelopeAttackCurve * 0.01f,
+                dspu::ADSREnvelope::function_t(af->nEnvelopeAttackType));
+            e->set_hold(
+                af->fEnvelopeHoldTime * 0.01f,
+                af->bEnvelopeHoldOn);
+            e->set_decay(
+                af->fEnvelopeDecayTime * 0.01f,
+                af->fEnvelopeDecayCurve * 0.01f,
+                dspu::ADSREnvelope::function_t(af->nEnvelopeDecayType));
+            e->set_break(
+                af->fEnvelopeBreakLevel * 0.01f,
+                af->bEnvelopeBreakOn);
+            e->set_slope(
+                af->fEnvelopeSlopeTime * 0.01f,
+                af->fEnvelopeSlopeCurve * 0.01f,
+                dspu::ADSREnvelope::function_t(af->nEnvelopeSlopeType));
+            e->set_sustain_level(af->fEnvelopeSustainLevel * 0.01f);
+            e->set_release(
+                af->fEnvelopeReleaseTime * 0.01f,
+                af->fEnvelopeReleaseCurve * 0.01f,
+                dspu::ADSREnvelope::function_t(af->nEnvelopeReleaseType));
+        }
+
+        uint64_t sampler_kernel::source_stage_hash(const afile_t *af, const dspu::Sample *src) const
+        {
+            const size_t sample_rate_dst        = nSampleRate * dspu::semitones_to_frequency_shift(-af->fPitch);
+
+            uint64_t hash           = STAGE_HASH_BASIS;
+            hash                    = stage_hash(hash, uintptr_t(src));
+            hash                    = stage_hash(hash, src->length());
+            hash                    = stage_hash(hash, sample_rate_dst);
+            if (src->sample_rate() != sample_rate_dst)
+                hash                    = stage_hash(hash, nResampleQuality);
+            hash                    = stage_hash(hash, (af->bPreReverse) && (!is_reverse_folded(af)));
+            hash                    = stage_hash(hash, af->bCompensate);
+            if (af->bCompensate)
+            {
+                const size_t chunk_size             = dspu::millis_to_samples(nSampleRate, af->fCompensateChunk);
+                const dspu::sample_crossfade_t fade_type  = (af->nCompensateFadeType == XFADE_LINEAR) ?
+                    dspu::SAMPLE_CROSSFADE_LINEAR :
+                    dspu::SAMPLE_CROSSFADE_CONST_POWER;
+                const float crossfade               = lsp_limit(af->fCompensateFade * 0.01f, 0.0f, 1.0f);
+
+                hash                    = stage_hash(hash, chunk_size);
+                hash                    = stage_hash(hash, fade_type);
+                hash                    = stage_hash(hash, crossfade);
+                hash                    = stage_hash(hash, nStretchEngine);
+            }
+
+            return stage_hash_commit(hash);
+        }
+
+        uint64_t sampler_kernel::stretch_stage_hash(const afile_t *af, size_t length) const
+        {
+            const ssize_t delta     = (af->bStretchOn) ? dspu::millis_to_samples(nSampleRate, af->fStretch) : 0;
+
+            // The stage depends on the result of the source stage
+            uint64_t hash           = STAGE_HASH_BASIS;
+            hash                    = stage_hash(hash, af->sSourceStage.nHash);
+            hash                    = stage_hash(hash, delta);
+            if (delta != 0)
+            {
+                const ssize_t start     = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchStart), 0, ssize_t(length));
+                const ssize_t end       = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchEnd), 0, ssize_t(length));
+                const size_t chunk_size = dspu::millis_to_samples(nSampleRate, af->fStretchChunk);
+                const dspu::sample_crossfade_t fade_type  = (af->nStretchFadeType == XFADE_LINEAR) ?
+                    dspu::SAMPLE_CROSSFADE_LINEAR :
+                    dspu::SAMPLE_CROSSFADE_CONST_POWER;
+                const float crossfade   = lsp_limit(af->fStretchFade * 0.01f, 0.0f, 1.0f);
+
+                hash                    = stage_hash(hash, start);
+                hash                    = stage_hash(hash, end);
+                hash                    = stage_hash(hash, chunk_size);
+                hash                    = stage_hash(hash, fade_type);
+                hash                    = stage_hash(hash, crossfade);
+                hash                    = stage_hash(hash, nStretchEngine);
+            }
+
+            return stage_hash_commit(hash);
+        }
+
+        bool sampler_kernel::is_reverse_folded(const afile_t *af) const
+        {
+            // Without compensation and stretch the pre-reverse does not affect the processing
+            // of the data, so it can be performed when copying the cut region
+            if ((!af->bPreReverse) || (af->bCompensate))
+                return false;
+            return (!af->bStretchOn) || (dspu::millis_to_samples(nSampleRate, af->fStretch) == 0);
+        }
+
+        bool sampler_kernel::is_prefix_render(const afile_t *af, const dspu::Sample *src) const
+        {
+            // The prefix can be rendered only when the source stage is the only expensive
+            // operation and it does not depend on the data outside of the prefix
+            if ((af->bPreReverse) || (af->bCompensate) || (af->enLoopMode != dspu::SAMPLE_LOOP_NONE))
+                return false;
+            if ((af->bStretchOn) && (dspu::millis_to_samples(nSampleRate, af->fStretch) != 0))
+                return false;
+
+            const size_t sample_rate_dst        = nSampleRate * dspu::semitones_to_frequency_shift(-af->fPitch);
+            if ((src->sample_rate() == sample_rate_dst) || (!sample_resampler::cubic_supported(src, sample_rate_dst)))
+                return false;
+
+            return af->sSourceStage.nHash != source_stage_hash(af, src);
+        }
+
+        status_t sampler_kernel::render_prefix(afile_t *af, dspu::Sample *src)
+        {
+            const size_t channels   = lsp_min(nChannels, src->channels());
+            const size_t src_rate   = src->sample_rate();
+            const size_t dst_rate   = nSampleRate * dspu::semitones_to_frequency_shift(-af->fPitch);
+
+            // Estimate the positions of the cut region in the resampled sample
+            const ssize_t length    = (wsize_t(src->length()) * dst_rate + src_rate - 1) / src_rate;
+            const ssize_t head_cut  = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fHeadCut), 0, length);
+            const ssize_t tail_cut  = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fTailCut), 0, length);
+            const ssize_t cut_length    = lsp_max(length - tail_cut - head_cut, 0);
+            const ssize_t prefix    = dspu::millis_to_samples(nSampleRate, RENDER_PREFIX_LENGTH);
+            const ssize_t fade_in   = dspu::millis_to_samples(nSampleRate, af->fFadeIn);
+            const ssize_t fade_out  = dspu::millis_to_samples(nSampleRate, af->fFadeOut);
+
+            // Render the prefix only if it saves enough time and is not affected by the fade-out
+            if ((cut_length < prefix * 2) || (fade_out > cut_length - prefix))
+                return STATUS_OK;
+
+            // Allocate user data
+            render_params_t *rp     = new render_params_t;
+            if (rp == NULL)
+                return STATUS_NO_MEM;
+            rp->nLength             = length;
+            rp->nHeadCut            = head_cut;
+            rp->nTailCut            = length - head_cut - prefix;
+            rp->nCutLength          = prefix;
+            rp->nStretchDelta       = 0;
+            rp->nStretchStart       = 0;
+            rp->nStretchEnd         = 0;
+            rp->nLoopStart          = 0;
+            rp->nLoopEnd            = 0;
+            rp->nLoopFade           = 0;
+            rp->bShared             = false;
+            rp->bReversed           = false;
+            rp->bDraft              = false;
+
+            // Allocate prefix sample and bind user data to it
+            dspu::Sample *out       = new dspu::Sample();
+            if (out == NULL)
+            {
+                delete rp;
+                return STATUS_NO_MEM;
+            }
+            out->set_user_data(rp);
+            lsp_finally { release_sample(out); };
+
+            if (!out->init(channels, prefix, prefix))
+                return STATUS_NO_MEM;
+            out->set_sample_rate(nSampleRate);
+
+            // Resample the prefix and apply the fade-in
+            for (size_t j=0; j<channels; ++j)
+            {
+                float *buf              = out->channel(j);
+                sample_resampler::cubic_read(buf, src->channel(j), src->length(), src_rate, dst_rate, head_cut, prefix);
+                dspu::fade_in(buf, buf, fade_in, prefix);
+            }
+
+            // Apply envelope if it is enabled, the envelope is computed for the whole cut region
+            if (af->bEnvelopeOn)
+            {
+                dspu::ADSREnvelope e;
+                configure_envelope(&e, af);
+
+                const float step    = 1.0f / cut_length;
+                for (size_t j=0; j<channels; ++j)
+                    e.generate_mul(out->channel(j), 0.0f, step, prefix);
+            }
+
+            // Publish the prefix for the playback
+            lsp_trace("Publishing sample prefix %p", out);
+            out                     = lsp::atomic_swap(&af->pPartial, out);
+
+            return STATUS_OK;
+        }
+
+        bool sampler_kernel::is_draft_render(const afile_t *af, const dspu::Sample *src) const
+        {
+            // The draft is rendered only if the full render uses expensive resampling or stretching
+            const size_t sample_rate_dst        = nSampleRate * dspu::semitones_to_frequency_shift(-af->fPitch);
+            const bool stretch      = (af->bStretchOn) && (dspu::millis_to_samples(nSampleRate, af->fStretch) != 0);
+            const bool fine_resample= (src->sample_rate() != sample_rate_dst) && (nResampleQuality != RESAMPLE_DRAFT);
+            const bool fine_stretch = (stretch) && (nStretchEngine != STRETCH_CLASSIC);
+            const bool fine_source  = (fine_resample) || ((af->bCompensate) && (nStretchEngine != STRETCH_CLASSIC));
+            if ((!fine_source) && (!fine_stretch))
+                return false;
+
+            // The draft is not required if the cached results of expensive stages can be re-used
+            const render_stage_t *ss            = &af->sSourceStage;
+            if (ss->nHash == source_stage_hash(af, src))
+            {
+                if (!fine_stretch)
+                    return false;
+                const size_t length     = (ss->pSample != NULL) ? ss->pSample->length() : src->length();
+                if (af->sStretchStage.nHash == stretch_stage_hash(af, length))
+                    return false;
+            }
+
+            // Render the draft only if the full render is expected to take long time
+            const size_t samples    = src->length() * lsp_min(nChannels, src->channels());
+            if (af->fStretchRate > 0.0f)
+                return float(samples) * 1000.0f >= af->fStretchRate * RENDER_DRAFT_THRESHOLD;
+
+            return samples >= size_t(dspu::millis_to_samples(nSampleRate, RENDER_DRAFT_LENGTH));
+        }
+
+        status_t sampler_kernel::render_draft(afile_t *af, dspu::Sample *src)
+        {
+            status_t res;
+            const size_t channels   = lsp_min(nChannels, src->channels());
+
+            // The draft is rendered with the draft resampler and the classic stretch engine
+            // without caching the results of render stages
+            const size_t sample_rate_dst        = nSampleRate * dspu::semitones_to_frequency_shift(-af->fPitch);
+            const bool reverse      = (af->bPreReverse) && (!is_reverse_folded(af));
+            const bool reversed     = is_reverse_folded(af);
+
+            dspu::Sample *temp      = new dspu::Sample();
+            if (temp == NULL)
+                return STATUS_NO_MEM;
+            lsp_finally { destroy_sample(temp); };
+
+            source_op_t op;
+            op.pResampler           = NULL;
+            op.pScratch             = &sScratch;
+            op.bReverse             = reverse;
+            op.bCompensate          = af->bCompensate;
+            op.nEngine              = STRETCH_CLASSIC;
+            op.nLength              = src->length();
+            op.nChunkSize           = (af->bCompensate) ? dspu::millis_to_samples(nSampleRate, af->fCompensateChunk) : 0;
+            op.enFadeType           = (af->nCompensateFadeType == XFADE_LINEAR) ?
+                dspu::SAMPLE_CROSSFADE_LINEAR :
+                dspu::SAMPLE_CROSSFADE_CONST_POWER;
+            op.fCrossfade           = (af->bCompensate) ? lsp_limit(af->fCompensateFade * 0.01f, 0.0f, 1.0f) : 0.0f;
+
+            polyphase_resampler resampler;
+            if (src->sample_rate() != sample_rate_dst)
+            {
+                if ((res = resampler.init(src->sample_rate(), sample_rate_dst, RESAMPLE_DRAFT, &sScratch)) != STATUS_OK)
+                    return res;
+                op.pResampler           = &resampler;
+            }
+
+            if (temp->copy(src) != STATUS_OK)
+                return STATUS_NO_MEM;
+            if ((res = af->pRenderer->process_channels(temp, source_op, &op)) != STATUS_OK)
+            {
+                lsp_warn("Error processing draft sample: %d", int(res));
+                return res;
+            }
+            const ssize_t src_length    = temp->length();
+
+            // Perform the stretch
+            const ssize_t delta     = (af->bStretchOn) ? dspu::millis_to_samples(nSampleRate, af->fStretch) : 0;
+            const ssize_t start     = (delta != 0) ? lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchStart), 0, src_length) : 0;
+            const ssize_t end       = (delta != 0) ? lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchEnd), 0, src_length) : 0;
+            if ((delta != 0) && (start <= end))
+            {
+                stretch_op_t sop;
+                sop.nEngine             = STRETCH_CLASSIC;
+                sop.pScratch            = &sScratch;
+                sop.nLength             = lsp_max(end + delta - start, 0);
+                sop.nChunkSize          = dspu::millis_to_samples(nSampleRate, af->fStretchChunk);
+                sop.enFadeType          = (af->nStretchFadeType == XFADE_LINEAR) ?
+                    dspu::SAMPLE_CROSSFADE_LINEAR :
+                    dspu::SAMPLE_CROSSFADE_CONST_POWER;
+                sop.fCrossfade          = lsp_limit(af->fStretchFade * 0.01f, 0.0f, 1.0f);
+                sop.nStart              = start;
+                sop.nEnd                = end;
+
+                if ((res = af->pRenderer->process_channels(temp, stretch_op, &sop)) != STATUS_OK)
+                {
+                    lsp_warn("Error stretching draft sample: %d", int(res));
+                    return res;
+                }
+            }
+
+            // Compute the tail and head cut positions and fades
+            const ssize_t length        = temp->length();
+            const ssize_t head_cut      = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fHeadCut), 0, length);
+            const ssize_t tail_cut      = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fTailCut), 0, length);
+            const ssize_t cut_length    = lsp_max(length - tail_cut - head_cut, 0);
+            const ssize_t fade_in       = dspu::millis_to_samples(nSampleRate, af->fFadeIn);
+            const ssize_t fade_out      = dspu::millis_to_samples(nSampleRate, af->fFadeOut);
+
+            // Allocate user data
+            render_params_t *rp     = new render_params_t;
+            if (rp == NULL)
+                return STATUS_NO_MEM;
+            rp->nLength             = length;
+            rp->nHeadCut            = head_cut;
+            rp->nTailCut            = tail_cut;
+            rp->nCutLength          = cut_length;
+            rp->nStretchDelta       = delta;
+            rp->nStretchStart       = (delta == 0) ? 0 : (start <= end) ? start : -1;
+            rp->nStretchEnd         = (delta == 0) ? 0 : (start <= end) ? end : -1;
+            rp->nLoopStart          = 0;
+            rp->nLoopEnd            = 0;
+            rp->nLoopFade           = 0;
+            rp->bShared             = false;
+            rp->bReversed           = reversed;
+            rp->bDraft              = true;
+
+            // Allocate draft sample and bind user data to it
+            dspu::Sample *out       = new dspu::Sample();
+            if (out == NULL)
+            {
+                delete rp;
+                return STATUS_NO_MEM;
+            }
+            out->set_user_data(rp);
+            lsp_finally { release_sample(out); };
+
+            if (!out->init(channels, cut_length, cut_length))
+                return STATUS_NO_MEM;
+            out->set_sample_rate(nSampleRate);
+
+            // Copy the cut region and apply fades and envelope
+            for (size_t j=0; j<channels; ++j)
+            {
+                float *buf              = out->channel(j);
+                if (reversed)
+                    dsp::reverse2(buf, temp->channel(j, length - head_cut - cut_length), cut_length);
+                else
+                    dsp::copy(buf, temp->channel(j, head_cut), cut_length);
+                dspu::fade_in(buf, buf, fade_in, cut_length);
+                dspu::fade_out(buf, buf, fade_out, cut_length);
+            }
+
+            if ((af->bEnvelopeOn) && (cut_length > 0))
+            {
+                dspu::ADSREnvelope e;
+                configure_envelope(&e, af);
+
+                const float step    = 1.0f / cut_length;
+                for (size_t j=0; j<channels; ++j)
+                    e.generate_mul(out->channel(j), 0.0f, step, cut_length);
+            }
+
+            // Render the thumbnails of the draft, they are shown until the full render completes
+            for (size_t j=0; j<channels; ++j)
+                analyze_sample(af->vDraftThumbs[j], af->vDraftCutThumbs[j], temp->channel(j), out->channel(j), rp);
+            normalize_thumbnails(af->vDraftThumbs, channels);
+            normalize_thumbnails(af->vDraftCutThumbs, channels);
+
+            af->fLength             = dspu::samples_to_millis(nSampleRate, src_length);
+            af->fActualLength       = dspu::samples_to_millis(nSampleRate, length);
+
+            // Publish the draft for the playback
+            lsp_trace("Publishing draft sample %p", out);
+            out                     = lsp::atomic_swap(&af->pPartial, out);
+
+            return STATUS_OK;
+        }
+
+        status_t sampler_kernel::render_source_stage(afile_t *af, dspu::Sample *src, dspu::Sample * &dst)
+        {
+            status_t res;
+            render_stage_t *st      = &af->sSourceStage;
+
+            // Compute the parameters of the stage
+            const size_t sample_rate_dst        = nSampleRate * dspu::semitones_to_frequency_shift(-af->fPitch);
+            const size_t chunk_size             = (af->bCompensate) ? dspu::millis_to_samples(nSampleRate, af->fCompensateChunk) : 0;
+            const dspu::sample_crossfade_t fade_type  = (af->nCompensateFadeType == XFADE_LINEAR) ?
+                dspu::SAMPLE_CROSSFADE_LINEAR :
+                dspu::SAMPLE_CROSSFADE_CONST_POWER;
+            const float crossfade               = (af->bCompensate) ? lsp_limit(af->fCompensateFade * 0.01f, 0.0f, 1.0f) : 0.0f;
+
+            const uint64_t hash     = source_stage_hash(af, src);
+
+            // Re-use the cached result if parameters did not change
+            if (st->nHash == hash)
+            {
+                dst                     = (st->pSample != NULL) ? st->pSample : src;
+                return STATUS_OK;
+            }
+            drop_render_stage(st);
+
+            // Pass the source sample as is if there is nothing to do
+            const bool reverse      = (af->bPreReverse) && (!is_reverse_folded(af));
+            if ((src->sample_rate() == sample_rate_dst) && (!reverse) && (!af->bCompensate))
+            {
+                st->nHash               = hash;
+                dst                     = src;
+                return STATUS_OK;
+            }
+
+            // Copy data of original sample to temporary sample and perform resampling
+            dspu::Sample *temp      = new dspu::Sample();
+            if (temp == NULL)
+                return STATUS_NO_MEM;
+            lsp_finally { destroy_sample(temp); };
+
+            source_op_t op;
+            op.pResampler           = NULL;
+            op.pScratch             = &sScratch;
+            op.bReverse             = reverse;
+            op.bCompensate          = af->bCompensate;
+            op.nEngine              = nStretchEngine;
+            op.nLength              = src->length();
+            op.nChunkSize           = chunk_size;
+            op.enFadeType           = fade_type;
+            op.fCrossfade           = crossfade;
+
+            // The kernel of the resampler is computed once and shared between all channels
+            polyphase_resampler resampler;
+            if (src->sample_rate() != sample_rate_dst)
+            {
+                if ((res = resampler.init(src->sample_rate(), sample_rate_dst, nResampleQuality, &sScratch)) != STATUS_OK)
+                {
+                    lsp_warn("Error initializing resampler: %d", int(res));
+                    return res;
+                }
+                op.pResampler           = &resampler;
+            }
+
+            if (temp->copy(src) != STATUS_OK)
+            {
+                lsp_warn("Error copying source sample");
+                return STATUS_NO_MEM;
+            }
+
+            // Channels are processed independently of each other
+            const wssize_t started  = system::get_time_millis();
+            if ((res = af->pRenderer->process_channels(temp, source_op, &op)) != STATUS_OK)
+            {
+                lsp_warn("Error processing source sample: %d", int(res));
+                return res;
+            }
+            if (af->bCompensate)
+                update_stretch_rate(af, src->length() * src->channels(), started);
+
+            // Commit the result of the stage
+            temp->gc_acquire();
+            lsp::swap(st->pSample, temp);
+            st->nHash               = hash;
+            dst                     = st->pSample;
+
+            return STATUS_OK;
+        }
+
+        status_t sampler_kernel::render_stretch_stage(afile_t *af, dspu::Sample * &sample)
+        {
+            status_t res;
+            render_stage_t *st      = &af->sStretchStage;
+            const ssize_t length    = sample->length();
+
+            // Compute the parameters of the stage
+            const ssize_t delta     = (af->bStretchOn) ? dspu::millis_to_samples(nSampleRate, af->fStretch) : 0;
+            const ssize_t start     = (delta != 0) ? lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchStart), 0, length) : 0;
+            const ssize_t end       = (delta != 0) ? lsp_limit(dspu::millis_to_samples(nSampleRate, af->fStretchEnd), 0, length) : 0;
+            const size_t chunk_size = (delta != 0) ? dspu::millis_to_samples(nSampleRate, af->fStretchChunk) : 0;
+            const dspu::sample_crossfade_t fade_type  = (af->nStretchFadeType == XFADE_LINEAR) ?
+                dspu::SAMPLE_CROSSFADE_LINEAR :
+                dspu::SAMPLE_CROSSFADE_CONST_POWER;
+            const float crossfade   = (delta != 0) ? lsp_limit(af->fStretchFade * 0.01f, 0.0f, 1.0f) : 0.0f;
+
+            const uint64_t hash     = stretch_stage_hash(af, length);
+
+            // Re-use the cached result if parameters did not change
+            if (st->nHash == hash)
+            {
+                if (st->pSample != NULL)
+                    sample                  = st->pSample;
+                return STATUS_OK;
+            }
+            drop_render_stage(st);
+
+            st->sParams.nStretchDelta   = delta;
+            if (delta != 0)
+            {
+                if (start <= end)
+                {
+                    dspu::Sample *temp      = new dspu::Sample();
+                    if (temp == NULL)
+                        return STATUS_NO_MEM;
+                    lsp_finally { destroy_sample(temp); };
+
+                    if (temp->copy(sample) != STATUS_OK)
+                    {
+                        lsp_warn("Error copying sample for stretching");
+                        return STATUS_NO_MEM;
+                    }
+
+                    // Perform stretch only when it is possible, do not report errors if stretch didn't succeed
+                    stretch_op_t op;
+                    op.nEngine              = nStretchEngine;
+                    op.pScratch             = &sScratch;
+                    op.nLength              = lsp_max(end + delta - start, 0);
+                    op.nChunkSize           = chunk_size;
+                    op.enFadeType           = fade_type;
+                    op.fCrossfade           = crossfade;
+                    op.nStart               = start;
+                    op.nEnd                 = end;
+
+                    const wssize_t started  = system::get_time_millis();
+                    res = af->pRenderer->process_channels(temp, stretch_op, &op);
+                    if (res == STATUS_OK)
+                    {
+                        update_stretch_rate(af, (end - start) * temp->channels(), started);
+                        temp->gc_acquire();
+                        lsp::swap(st->pSample, temp);
+                    }
+                    else
+                    {
+                        lsp_trace("Failed to stretch sample: %d", int(res));
+                        st->sParams.nStretchDelta   = 0;
+                    }
+
+                    st->sParams.nStretchStart   = start;
+                    st->sParams.nStretchEnd     = end;
+                }
+                else
+                {
+                    st->sParams.nStretchStart   = -1;
+                    st->sParams.nStretchEnd     = -1;
+                }
+            }
+
+            // Commit the result of the stage
+            st->nHash               = hash;
+            if (st->pSample != NULL)
+                sample                  = st->pSample;
+
+            return STATUS_OK;
+        }
+
+        status_t sampler_kernel::render_cut_stage(afile_t *af, dspu::Sample *src, dspu::Sample * &dst)
+        {
+            render_stage_t *st      = &af->sCutStage;
+            const size_t channels   = src->channels();
+
+            // Compute the tail and head cut positions and fades
+            const ssize_t length        = src->length();
+            const ssize_t head_cut      = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fHeadCut), 0, length);
+            const ssize_t tail_cut      = lsp_limit(dspu::millis_to_samples(nSampleRate, af->fTailCut), 0, length);
+            const ssize_t cut_length    = lsp_max(length - tail_cut - head_cut, 0);
+            const ssize_t fade_in       = dspu::millis_to_samples(nSampleRate, af->fFadeIn);
+            const ssize_t fade_out      = dspu::millis_to_samples(nSampleRate, af->fFadeOut);
+            const bool reversed         = is_reverse_folded(af);
+
+            // The stage depends on the result of the stretch stage
+            uint64_t hash           = STAGE_HASH_BASIS;
+            hash                    = stage_hash(hash, af->sStretchStage.nHash);
+            hash                    = stage_hash(hash, reversed);
+            hash                    = stage_hash(hash, head_cut);
+            hash                    = stage_hash(hash, tail_cut);
+            hash                    = stage_hash(hash, fade_in);
+            hash                    = stage_hash(hash, fade_out);
+            hash                    = stage_hash_commit(hash);
+
+            // Re-use the cached result if parameters did not change
+            if ((st->nHash == hash) && (st->pSample != NULL))
+            {
+                dst                     = st->pSample;
+                return STATUS_OK;
+            }
+            drop_render_stage(st);
+
+            // Only the region between head and tail cut is stored, the stage result can be
+            // used for playback directly, so it carries the render parameters
+            render_params_t *rp     = new render_params_t;
+            if (rp == NULL)
+                return STATUS_NO_MEM;
+            dspu::Sample *temp      = new dspu::Sample();
+            if (temp == NULL)
+            {
+                delete rp;
+                return STATUS_NO_MEM;
+            }
+            temp->set_user_data(rp);
+            lsp_finally { destroy_sample(temp); };
+
+            if (!temp->init(channels, cut_length, cut_length))
+            {
+                lsp_warn("Error initializing cut sample");
+                return STATUS_NO_MEM;
+            }
+            temp->set_sample_rate(src->sample_rate());
+
+            // Copy the region and apply the fade-in and fade-out. The cut positions are
+            // specified for the reversed data if the reverse is folded into this stage
+            for (size_t j=0; j<channels; ++j)
+            {
+                float *buf              = temp->channel(j);
+                if (reversed)
+                    dsp::reverse2(buf, src->channel(j, length - head_cut - cut_length), cut_length);
+                else
+                    dsp::copy(buf, src->channel(j, head_cut), cut_length);
+                dspu::fade_in(buf, buf, fade_in, cut_length);
+                dspu::fade_out(buf, buf, fade_out, cut_length);
+            }
+
+            // Commit the result of the stage
+            st->sParams             = af->sStretchStage.sParams;
+            st->sParams.nLength     = length;
+            st->sParams.nHeadCut    = head_cut;
+            st->sParams.nTailCut    = tail_cut;
+            st->sParams.nCutLength  = cut_length;
+            st->sParams.bShared     = true;
+            st->sParams.bReversed   = reversed;
+            *rp                     = st->sParams;
+            temp->gc_acquire();
+            lsp::swap(st->pSample, temp);
+            st->nHash               = hash;
+            dst                     = st->pSample;
+
+            return STATUS_OK;
+        }
+
+        status_t sampler_kernel::render_sample(afile_t *af)
+        {
+            status_t res;
+
+            // Validate arguments
+            if (af == NULL)
+                return STATUS_UNKNOWN_ERR;
+
+            // Get maximum sample count
+            dspu::Sample *src       = af->pOriginal;
+            if (src == NULL)
+                return STATUS_UNSPECIFIED;
+
+            // Avoid any copies if there is nothing to process
+            if (is_identity_render(af, src))
+                return render_identity(af, src);
+
+            // Temporary buffers of the render are allocated from the scratch arena
+            sScratch.begin();
+            lsp_finally { sScratch.end(); };
+
+            // Publish the playable prefix of the sample first if the source stage takes long time,
+            // reclaim it after the render if it has not been bound by the audio thread
+            lsp_finally {
+                dspu::Sample *partial   = lsp::atomic_swap(&af->pPartial, NULL);
+                destroy_sample(partial);
+            };
+            if (is_prefix_render(af, src))
+            {
+                if ((res = render_prefix(af, src)) != STATUS_OK)
+                    return res;
+            }
+            else if (is_draft_render(af, src))
+            {
+                // Publish the draft render with coarse settings first if the full render takes long time
+                if ((res = render_draft(af, src)) != STATUS_OK)
+                    return res;
+            }
+
+            // Obtain the result of the source stage: resampling, reversal and compensation
+            dspu::Sample *stage     = NULL;
+            size_t channels         = lsp_min(nChannels, src->channels());
+            if ((res = render_source_stage(af, src, stage)) != STATUS_OK)
+                return res;
+            af->fLength             = dspu::samples_to_millis(nSampleRate, stage->length());
+
+            // Obtain the result of the stretch stage
+            if ((res = render_stretch_stage(af, stage)) != STATUS_OK)
+                return res;
+
+            // Obtain the result of the cut stage
+            dspu::Sample *cut       = NULL;
+            if ((res = render_cut_stage(af, stage, cut)) != STATUS_OK)
+                return res;
+            const render_stage_t *cs    = &af->sCutStage;
+            af->fActualLength       = dspu::samples_to_millis(nSampleRate, cs->sParams.nLength);
+
+            // The cut stage can be played back directly if there is no envelope to apply
+            // and no loop cross-fade to bake
+            if (((!af->bEnvelopeOn) || (cs->sParams.nCutLength <= 0)) && (!is_loop_baked(af)))
+            {
+                for (size_t j=0; j<channels; ++j)
+                    analyze_sample(af->vThumbs[j], af->vCutThumbs[j], stage->channel(j), cut->channel(j), &cs->sParams);
+                normalize_thumbnails(af->vThumbs, channels);
+                normalize_thumbnails(af->vCutThumbs, channels);
+
+                dspu::Sample *out       = cut;
+                out->gc_acquire();
+                lsp::swap(out, af->pProcessed);
+                release_sample(out);
+
+                return STATUS_OK;
+            }
+
+            // Allocate user data
+            render_params_t *rp     = new render_params_t;
+            if (rp == NULL)
+                return STATUS_NO_MEM;
+            *rp                     = cs->sParams;
+            rp->bShared             = false;
+
+            // Allocate target sample and bind user data to it
+            dspu::Sample *out   = new dspu::Sample();
+            if (out == NULL)
+            {
+                delete rp;
+                return STATUS_NO_MEM;
+            }
+            lsp_trace("Allocated sample %p", out);
+            out->set_user_data(rp);
+            lsp_finally { release_sample(out); };
+            out->set_sample_rate(nSampleRate);
+
+            // Initialize target sample
+            if (!out->resize(channels, rp->nCutLength, rp->nCutLength))
+            {
+                lsp_warn("Error initializing playback sample");
+                return STATUS_NO_MEM;
+            }
+            advise_sample_memory(out);
+
+            // The cut stage is kept intact, the envelope is applied to the target sample
+            for (size_t j=0; j<channels; ++j)
+                dsp::copy(out->channel(j), cut->channel(j), rp->nCutLength);
+
+            // Apply envelope if it is enabled
             if ((af->bEnvelopeOn) && (rp->nCutLength > 0))
             {
                 dspu::ADSREnvelope e;
-                e.set_attack(
-                    af->fEnvelopeAttackTime * 0.01f,
-                    af->fEnvelopeAttackCurve * 0.01f,
-                    dspu::ADSREnvelope::function_t(af->nEnvelopeAttackType));
-                e.set_hold(
-                    af->fEnvelopeHoldTime * 0.01f,
-                    af->bEnvelopeHoldOn);
-                e.set_decay(
-                    af->fEnvelopeDecayTime * 0.01f,
-                    af->fEnvelopeDecayCurve * 0.01f,
-                    dspu::ADSREnvelope::function_t(af->nEnvelopeDecayType));
-                e.set_break(
-                    af->fEnvelopeBreakLevel * 0.01f,
-                    af->bEnvelopeBreakOn);
-                e.set_slope(
-                    af->fEnvelopeSlopeTime * 0.01f,
-                    af->fEnvelopeSlopeCurve * 0.01f,
-                    dspu::ADSREnvelope::function_t(af->nEnvelopeSlopeType));
-                e.set_sustain_level(af->fEnvelopeSustainLevel * 0.01f);
-                e.set_release(
-                    af->fEnvelopeReleaseTime * 0.01f,
-                    af->fEnvelopeReleaseCurve * 0.01f,
-                    dspu::ADSREnvelope::function_t(af->nEnvelopeReleaseType));
+                configure_envelope(&e, af);
 
                 const float step    = 1.0f / rp->nCutLength;
                 for (size_t j=0; j<channels; ++j)
                 {
-                    float *dst          = temp.channel(j, rp->nHeadCut);
+                    float *dst          = out->channel(j);
                     e.generate_mul(dst, 0.0f, step, rp->nCutLength);
                 }
             }
 
+            // Bake the loop cross-fade into the sample data
+            if (is_loop_baked(af))
+                bake_loop_crossfade(af, out, rp);
+
             // Render the thumbnails
-            {
-                const float scaling     = float(rp->nLength) / meta::sampler_metadata::MESH_SIZE;
-                for (size_t j=0; j<channels; ++j)
-                {
-                    const float *src    = temp.channel(j);
-                    float *dst          = af->vThumbs[j];
+            for (size_t j=0; j<channels; ++j)
+                analyze_sample(af->vThumbs[j], af->vCutThumbs[j], stage->channel(j), out->channel(j), rp);
+            normalize_thumbnails(af->vThumbs, channels);
+            normalize_thumbnails(af->vCutThumbs, channels);
 
-                    for (size_t k=0; k<meta::sampler_metadata::MESH_SIZE; ++k)
-                    {
-                        const ssize_t first = k * scaling;
-                        const ssize_t last  = (k + 1) * scaling;
-                        if (first < last)
-                            dst[k]              = dsp::abs_max(&src[first], last - first);
-                        else if (first < rp->nLength)
-                            dst[k]              = fabs(src[first]);
-                        else
-                            dst[k]              = 0.0f;
-                    }
+            // Commit the new sample to the processed
+            rp  = static_cast<render_params_t *>(out->set_user_data(rp));
+            lsp::swap(out, af->pProcessed);
 
-                    // Normalize graph if possible
-                    if (norming != 1.0f)
-                        dsp::mul_k2(dst, norming, meta::sampler_metadata::MESH_SIZE);
-                }
-            }
+            return STATUS_OK;
+        }
+
+        status_t sampler_kernel::render_variants(afile_t *af)
+        {
+            status_t res;
+
+            // Drop variants of the previous render that have not been bound
+            release_variants(af);
+
+            // The variants are rendered from the processed sample only for keys within the range
+            const ssize_t range     = nKeyRange;
+            dspu::Sample *base      = af->pProcessed;
+            if ((base == NULL) || (range <= 0) || (base->length() <= 0))
+                return STATUS_OK;
+
+            sScratch.begin();
+            lsp_finally { sScratch.end(); };
+
+            const size_t sample_rate    = base->sample_rate();
+            const size_t base_length    = base->length();
+            const render_params_t *brp  = static_cast<const render_params_t *>(base->user_data());
 
-            // Render the cut thumbnails
+            for (ssize_t key = -range; key <= range; ++key)
             {
-                const float scaling     = float(rp->nCutLength) / meta::sampler_metadata::MESH_SIZE;
-                for (size_t j=0; j<channels; ++j)
+                if (key == 0)
+                    continue;
+
+                // The variant is the processed sample resampled to the pitch of the key
+                source_op_t op;
+                op.pResampler           = NULL;
+                op.pScratch             = &sScratch;
+                op.bReverse             = false;
+                op.bCompensate          = false;
+                op.nEngine              = nStretchEngine;
+                op.nLength              = 0;
+                op.nChunkSize           = 0;
+                op.enFadeType           = dspu::SAMPLE_CROSSFADE_CONST_POWER;
+                op.fCrossfade           = 0.0f;
+
+                polyphase_resampler resampler;
+                const size_t sample_rate_dst    = sample_rate * dspu::semitones_to_frequency_shift(-key);
+                if ((res = resampler.init(sample_rate, sample_rate_dst, nResampleQuality, &sScratch)) != STATUS_OK)
                 {
-                    const float *src    = temp.channel(j, rp->nHeadCut);
-                    float *dst          = af->vCutThumbs[j];
+                    lsp_warn("Error initializing variant resampler: %d", int(res));
+                    return res;
+                }
+                op.pResampler           = &resampler;
 
-                    for (size_t k=0; k<meta::sampler_metadata::MESH_SIZE; ++k)
-                    {
-                        const ssize_t first = k * scaling;
-                        const ssize_t last  = (k + 1) * scaling;
-                        if (first < last)
-                            dst[k]              = dsp::abs_max(&src[first], last - first);
-                        else if (first < rp->nCutLength)
-                            dst[k]              = fabs(src[first]);
-                        else
-                            dst[k]              = 0.0f;
-                    }
+                dspu::Sample *out       = new dspu::Sample();
+                if (out == NULL)
+                    return STATUS_NO_MEM;
+                lsp_finally { destroy_sample(out); };
+
+                if (out->copy(base) != STATUS_OK)
+                {
+                    lsp_warn("Error copying variant sample");
+                    return STATUS_NO_MEM;
+                }
+                if ((res = af->pRenderer->process_channels(out, source_op, &op)) != STATUS_OK)
+                {
+                    lsp_warn("Error processing variant sample: %d", int(res));
+                    return res;
+                }
 
-                    // Normalize graph if possible
-                    if (cut_norming != 1.0f)
-                        dsp::mul_k2(dst, cut_norming, meta::sampler_metadata::MESH_SIZE);
+                // The variant is played at the sample rate of the processed sample
+                const size_t length     = out->length();
+                out->set_sample_rate(sample_rate);
+                advise_sample_memory(out);
+
+                // Allocate user data, the variant keeps render parameters of the processed sample
+                // and the loop cross-fade baked into it is kept at the scaled position
+                render_params_t *rp     = new render_params_t;
+                if (rp == NULL)
+                    return STATUS_NO_MEM;
+                if (brp != NULL)
+                    *rp                     = *brp;
+                else
+                {
+                    rp->nLength             = base_length;
+                    rp->nHeadCut            = 0;
+                    rp->nTailCut            = 0;
+                    rp->nCutLength          = base_length;
+                    rp->nStretchDelta       = 0;
+                    rp->nStretchStart       = 0;
+                    rp->nStretchEnd         = 0;
+                    rp->nLoopStart          = 0;
+                    rp->nLoopEnd            = 0;
+                    rp->nLoopFade           = 0;
+                    rp->bReversed           = false;
                 }
-            }
+                rp->bShared             = false;
+                rp->bDraft              = false;
+                if (rp->nLoopFade > 0)
+                {
+                    rp->nLoopStart          = scale_position(rp->nLoopStart, length, rp->nCutLength);
+                    rp->nLoopEnd            = scale_position(rp->nLoopEnd, length, rp->nCutLength);
+                    rp->nLoopFade           = scale_position(rp->nLoopFade, length, rp->nCutLength);
+                }
+                out->set_user_data(rp);
 
-            // Perform the head and tail cut operations
-            // Initialize target sample
-            if (!out->resize(channels, rp->nCutLength, rp->nCutLength))
-            {
-                lsp_warn("Error initializing playback sample");
-                return STATUS_NO_MEM;
+                // Publish the variant for the bind
+                lsp::swap(out, af->vVariants[variant_slot(key)]);
             }
 
-            // Apply head cut and tail cut
-            for (size_t j=0; j<channels; ++j)
+            return STATUS_OK;
+        }
+
+        bool sampler_kernel::is_loop_baked(const afile_t *af) const
+        {
+            // Only loops which jump from one end of the range to another one have cross-fade,
+            // playback of the post-reversed sample is not supported
+            if ((!bLoopBake) || (af->bPostReverse) || (af->fLoopFade <= 0.0f))
+                return false;
+            return (af->enLoopMode == dspu::SAMPLE_LOOP_DIRECT) || (af->enLoopMode == dspu::SAMPLE_LOOP_REVERSE);
+        }
+
+        void sampler_kernel::bake_loop_crossfade(const afile_t *af, dspu::Sample *s, render_params_t *rp)
+        {
+            ssize_t loop_start  = compute_loop_point(s, af->fLoopStart);
+            ssize_t loop_end    = compute_loop_point(s, af->fLoopEnd);
+            if (loop_end < loop_start)
+                lsp::swap(loop_end, loop_start);
+            if (loop_start < 0)
+                return;
+
+            // Loop points are computed for the uncut sample, the player limits them to the sample length
+            const ssize_t length    = s->length();
+            loop_start              = lsp_min(loop_start, length);
+            loop_end                = lsp_min(loop_end, length);
+            if (loop_end <= loop_start)
+                return;
+
+            // Baking modifies the data at the loop exit, so the playback that leaves the loop after
+            // the note-off would hit a step against the untouched data behind it. Keep the live
+            // cross-fade for loops that are followed by the release tail.
+            const bool reverse      = af->enLoopMode == dspu::SAMPLE_LOOP_REVERSE;
+            if ((reverse) ? (loop_start > 0) : (loop_end < length))
+                return;
+
+            // The cross-fade mixes the data outside of the loop, so it should fit the sample
+            ssize_t fade            = lsp_min(ssize_t(dspu::millis_to_samples(nSampleRate, af->fLoopFade)), loop_end - loop_start);
+            fade                    = (reverse) ? lsp_min(fade, length - loop_end) : lsp_min(fade, loop_start);
+            if (fade <= 0)
+                return;
+
+            // Direct loop jumps from the end to the start, so the end of the loop fades into the data
+            // preceding the loop start. Reverse loop jumps from the start to the end, so the start of
+            // the loop fades into the data following the loop end.
+            const bool linear       = af->nLoopFadeType == XFADE_LINEAR;
+            const float k           = 1.0f / fade;
+            for (size_t j=0, n=s->channels(); j<n; ++j)
             {
-                const float *src    = temp.channel(j, rp->nHeadCut);
-                float *dst          = out->channel(j);
-                dsp::copy(dst, src, rp->nCutLength);
-            }
+                float *dst              = s->channel(j);
+                float *head             = (reverse) ? &dst[loop_start] : &dst[loop_end - fade];
+                const float *tail       = (reverse) ? &dst[loop_end] : &dst[loop_start - fade];
 
-            // Commit the new sample to the processed
-            rp  = static_cast<render_params_t *>(out->set_user_data(rp));
-            lsp::swap(out, af->pProcessed);
+                for (ssize_t i=0; i<fade; ++i)
+                {
+                    const float t           = (reverse) ? (fade - i - 0.5f) * k : (i + 0.5f) * k;
+                    const float k_in        = (linear) ? t : sinf(t * M_PI * 0.5f);
+                    const float k_out       = (linear) ? 1.0f - t : cosf(t * M_PI * 0.5f);
+                    head[i]                 = head[i] * k_out + tail[i] * k_in;
+                }
+            }
 
-            return STATUS_OK;
+            rp->nLoopStart          = loop_start;
+            rp->nLoopEnd            = loop_end;
+            rp->nLoopFade           = fade;
         }
 
         ssize_t sampler_kernel::compute_loop_point(const dspu::Sample *s, size_t position)
@@ -1145,6 +2638,29 @@ namespace lsp
             return pos;
         }
 
+        ssize_t sampler_kernel::scale_position(ssize_t position, size_t length, size_t base_length)
+        {
+            if ((position < 0) || (base_length <= 0))
+                return position;
+            return (wsize_t(position) * length) / base_length;
+        }
+
+        size_t sampler_kernel::variant_slot(ssize_t key)
+        {
+            // Keys above the note occupy the first half of slots, keys below the note - the second one
+            return (key > 0) ? size_t(key) - 1 : meta::sampler_metadata::KEY_RANGE_MAX + size_t(-key) - 1;
+        }
+
+        size_t sampler_kernel::sample_id(const afile_t *af, ssize_t key) const
+        {
+            return (key == 0) ? af->nID : af->nID + nFiles * (variant_slot(key) + 1);
+        }
+
+        dspu::Playback *sampler_kernel::key_playback(afile_t *af, ssize_t key)
+        {
+            return (key == 0) ? af->vPlayback : af->vKeyPlayback[variant_slot(key)];
+        }
+
         void sampler_kernel::cancel_sample(afile_t *af, size_t delay)
         {
             size_t fadeout  = dspu::millis_to_samples(nSampleRate, fFadeout);
@@ -1158,41 +2674,271 @@ namespace lsp
 
             for (size_t i=0; i<4; ++i)
                 af->vPlayback[i].clear();
+
+            cancel_variants(af, delay);
         }
 
-        void sampler_kernel::play_sample(afile_t *af, float gain, size_t delay, play_mode_t mode, bool listen)
+        void sampler_kernel::cancel_variants(afile_t *af, size_t delay)
         {
-            lsp_trace("id=%d, gain=%f, delay=%d", int(af->nID), gain, int(delay));
+            size_t fadeout  = dspu::millis_to_samples(nSampleRate, fFadeout);
 
-            // Obtain the sample that will be used for playback
-            dspu::Sample *s = vChannels[0].get(af->nID);
-            if (s == NULL)
+            // Variants are played only for keys within the range
+            for (ssize_t key = -ssize_t(nKeyRange); key <= ssize_t(nKeyRange); ++key)
+            {
+                if (key == 0)
+                    continue;
+
+                const size_t id     = sample_id(af, key);
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    dspu::SamplePlayer *p = &vChannels[i];
+                    for (size_t j=0; j<nChannels; ++j)
+                        p->cancel_all(id, j, fadeout, delay, dspu::SAMPLER_PLAYBACK);
+                }
+
+                dspu::Playback *vpb = key_playback(af, key);
+                for (size_t i=0; i<4; ++i)
+                    vpb[i].clear();
+            }
+        }
+
+        void sampler_kernel::bind_variants(afile_t *af)
+        {
+            // The sample player takes the ownership of the bound variants, missing variants are unbound
+            for (ssize_t key = -ssize_t(meta::sampler_metadata::KEY_RANGE_MAX);
+                key <= ssize_t(meta::sampler_metadata::KEY_RANGE_MAX); ++key)
+            {
+                if (key == 0)
+                    continue;
+
+                const size_t slot   = variant_slot(key);
+                const size_t id     = sample_id(af, key);
+                dspu::Sample *s     = af->vVariants[slot];
+                for (size_t j=0; j<nChannels; ++j)
+                {
+                    if (s != NULL)
+                        vChannels[j].bind(id, s);
+                    else
+                        vChannels[j].unbind(id);
+                }
+                af->vVariants[slot] = NULL;
+            }
+        }
+
+        void sampler_kernel::release_variants(afile_t *af)
+        {
+            for (size_t i=0; i<KEY_VARIANTS; ++i)
+                release_sample(af->vVariants[i]);
+        }
+
+        bool sampler_kernel::start_voice(afile_t *af, ssize_t key, float gain, size_t delay)
+        {
+            // Voices are not tracked if there is no polyphony limit
+            if ((nPolyphony <= 0) && (!bTrackVoices))
+                return play_sample(af, key, gain, delay, PLAY_NOTE, false);
+
+            // Do not steal voices if there is nothing to play
+            if (vChannels[0].get(sample_id(af, key)) == NULL)
+                return false;
+
+            // Steal voices to fit the new one into the polyphony limit of the instrument.
+            // Voices tracked only for the limit of the plugin are stolen by the plugin.
+            while ((nPolyphony > 0) && (nVoices >= nPolyphony))
+            {
+                voice_info_t info;
+                const ssize_t index = select_voice(&info, nStealPolicy, af->nID, key);
+                if (index < 0)
+                    break;
+                steal_voice(index, delay);
+            }
+
+            // Start the playback and track it. The tracking array fits the maximum limit of the
+            // plugin, it gets full only if more voices start within one block than the limit
+            // allows. Such voices are played untracked and do not count for the limit.
+            if (!play_sample(af, key, gain, delay, PLAY_NOTE, false))
+                return false;
+            if (nVoices >= meta::sampler_metadata::TOTAL_VOICES_MAX)
+                return true;
+
+            const dspu::Playback *vpb = key_playback(af, key);
+            voice_t *v          = &vVoices[nVoices++];
+            for (size_t i=0; i<4; ++i)
+                v->vPlayback[i]     = vpb[i];
+            v->nStart           = nTime + delay;
+            v->nFile            = af->nID;
+            v->nKey             = key;
+            v->fGain            = gain;
+            v->bReleased        = false;
+            nLastVoice          = lsp_max(nLastVoice, v->nStart);
+
+            return true;
+        }
+
+        void sampler_kernel::remove_voice(size_t index)
+        {
+            // Move the last voice to the place of removed one
+            voice_t *v          = &vVoices[index];
+            voice_t *last       = &vVoices[--nVoices];
+            if (v != last)
+            {
+                for (size_t i=0; i<4; ++i)
+                    v->vPlayback[i]     = last->vPlayback[i];
+                v->nStart           = last->nStart;
+                v->nFile            = last->nFile;
+                v->nKey             = last->nKey;
+                v->fGain            = last->fGain;
+                v->bReleased        = last->bReleased;
+            }
+
+            for (size_t i=0; i<4; ++i)
+                last->vPlayback[i].clear();
+        }
+
+        void sampler_kernel::drop_voices()
+        {
+            while (nVoices > 0)
+                remove_voice(nVoices - 1);
+        }
+
+        void sampler_kernel::release_voices(bool note_off, ssize_t key)
+        {
+            for (size_t i=0; i<nVoices; ++i)
+            {
+                voice_t *v          = &vVoices[i];
+                if (v->nKey != key)
+                    continue;
+                if ((note_off) || (vFiles[v->nFile].enLoopMode != dspu::SAMPLE_LOOP_NONE))
+                    v->bReleased        = true;
+            }
+        }
+
+        bool sampler_kernel::steal_first(const voice_info_t *a, const voice_info_t *b, size_t policy)
+        {
+            switch (policy)
+            {
+                case STEAL_QUIETEST:
+                    if (a->fGain != b->fGain)
+                        return a->fGain < b->fGain;
+                    break;
+                case STEAL_SAME_NOTE:
+                    if (a->bSameNote != b->bSameNote)
+                        return a->bSameNote;
+                    break;
+                case STEAL_RELEASED:
+                    if (a->bReleased != b->bReleased)
+                        return a->bReleased;
+                    break;
+                default:
+                    break;
+            }
+
+            // The oldest voice is stolen first
+            return a->nStart < b->nStart;
+        }
+
+        ssize_t sampler_kernel::select_voice(voice_info_t *info, size_t policy, ssize_t file, ssize_t key) const
+        {
+            ssize_t index       = -1;
+
+            for (size_t i=0; i<nVoices; ++i)
+            {
+                const voice_t *v    = &vVoices[i];
+
+                voice_info_t vi;
+                vi.nStart           = v->nStart;
+                vi.fGain            = v->fGain;
+                vi.bReleased        = v->bReleased;
+                vi.bSameNote        = (file >= 0) && (v->nFile == size_t(file)) && (v->nKey == key);
+
+                if ((index < 0) || (steal_first(&vi, info, policy)))
+                {
+                    *info               = vi;
+                    index               = i;
+                }
+            }
+
+            return index;
+        }
+
+        void sampler_kernel::steal_voice(size_t index, size_t delay)
+        {
+            if (index >= nVoices)
                 return;
 
+            // Stolen voices are faded out faster than cancelled ones
+            const size_t fadeout    = dspu::millis_to_samples(nSampleRate, meta::sampler_metadata::STEAL_FADEOUT);
+            voice_t *v              = &vVoices[index];
+            for (size_t i=0; i<4; ++i)
+                v->vPlayback[i].cancel(fadeout, delay);
+
+            remove_voice(index);
+        }
+
+        void sampler_kernel::process_finished_voices()
+        {
+            // Stop tracking voices which playbacks have ended
+            for (size_t i=0; i<nVoices; )
+            {
+                const voice_t *v    = &vVoices[i];
+                if ((v->vPlayback[0].valid()) || (v->vPlayback[1].valid()) ||
+                    (v->vPlayback[2].valid()) || (v->vPlayback[3].valid()))
+                    ++i;
+                else
+                    remove_voice(i);
+            }
+        }
+
+        bool sampler_kernel::play_sample(afile_t *af, ssize_t key, float gain, size_t delay, play_mode_t mode, bool listen)
+        {
+            lsp_trace("id=%d, key=%d, gain=%f, delay=%d", int(af->nID), int(key), gain, int(delay));
+
+            // Obtain the sample that will be used for playback, keys other than the note
+            // of the instrument play the pitch variant of the sample
+            const size_t id     = sample_id(af, key);
+            dspu::Sample *s     = vChannels[0].get(id);
+            if (s == NULL)
+                return false;
+
             // Scale the final output gain
             dspu::PlaySettings ps;
+            const render_params_t *rp = static_cast<render_params_t *>(s->user_data());
             ssize_t loop_start  = compute_loop_point(s, af->fLoopStart);
             ssize_t loop_end    = compute_loop_point(s, af->fLoopEnd);
             if (loop_end < loop_start)
                 lsp::swap(loop_end, loop_start);
 
-            ps.set_sample_id(af->nID);
+            // Render parameters of the pitch variant are the ones of the processed sample
+            // it has been rendered from, so the loop points are scaled to the variant length
+            if ((key != 0) && (rp != NULL))
+            {
+                loop_start          = scale_position(loop_start, s->length(), rp->nCutLength);
+                loop_end            = scale_position(loop_end, s->length(), rp->nCutLength);
+            }
+
+            ps.set_sample_id(id);
             if ((loop_start >= 0) && (loop_end >= 0))
                 ps.set_loop_range(af->enLoopMode, loop_start, loop_end);
+
+            // The cross-fade is not required if it has been baked for the same loop range,
+            // the baked range is limited to the sample length like the one of the player
+            const ssize_t length = s->length();
+            const bool baked    = (rp != NULL) && (rp->nLoopFade > 0) &&
+                                  (rp->nLoopStart == lsp_min(loop_start, length)) &&
+                                  (rp->nLoopEnd == lsp_min(loop_end, length));
             ps.set_loop_xfade(
                 (af->nLoopFadeType == XFADE_LINEAR) ? dspu::SAMPLE_CROSSFADE_LINEAR : dspu::SAMPLE_CROSSFADE_CONST_POWER,
-                dspu::millis_to_samples(nSampleRate, af->fLoopFade));
+                (baked) ? 0 : dspu::millis_to_samples(nSampleRate, af->fLoopFade));
             ps.set_delay(delay);
             ps.set_start((af->bPostReverse) ? s->length() : 0, af->bPostReverse);
             ps.set_listen(listen);
 
             dspu::Playback *vpb = (mode == PLAY_FILE) ? af->vListen :
                                   (mode == PLAY_INSTRUMENT) ? vListen :
-                                  af->vPlayback;
+                                  key_playback(af, key);
             gain               *= af->fMakeup;
             if (nChannels == 1)
             {
-                lsp_trace("channels[%d].play(%d, %d, %f, %d)", int(0), int(af->nID), int(0), gain * af->fGains[0], int(delay));
+                lsp_trace("channels[%d].play(%d, %d, %f, %d)", int(0), int(id), int(0), gain * af->fGains[0], int(delay));
                 ps.set_sample_channel(0);
                 ps.set_volume(gain * af->fGains[0]);
                 vpb[0] = vChannels[0].play(&ps);
@@ -1205,14 +2951,16 @@ namespace lsp
                     size_t j=i^1; // j = (i + 1) % 2
                     ps.set_sample_channel(i % s->channels());
 
-                    lsp_trace("channels[%d].play(%d, %d, %f, %d)", int(i), int(af->nID), int(i), gain * af->fGains[i], int(delay));
+                    lsp_trace("channels[%d].play(%d, %d, %f, %d)", int(i), int(id), int(i), gain * af->fGains[i], int(delay));
                     ps.set_volume(gain * af->fGains[i]);
                     vpb[pb_id++] = vChannels[i].play(&ps);
-                    lsp_trace("channels[%d].play(%d, %d, %f, %d)", int(j), int(i), int(af->nID), gain * (1.0f - af->fGains[i]), int(delay));
+                    lsp_trace("channels[%d].play(%d, %d, %f, %d)", int(j), int(i), int(id), gain * (1.0f - af->fGains[i]), int(delay));
                     ps.set_volume(gain * (1.0f - af->fGains[i]));
                     vpb[pb_id++] = vChannels[j].play(&ps);
                 }
             }
+
+            return true;
         }
 
         void sampler_kernel::stop_listen_file(afile_t *af, bool force)
@@ -1234,7 +2982,7 @@ namespace lsp
 
         void sampler_kernel::start_listen_file(afile_t *af, float gain)
         {
-            play_sample(af, gain, 0, PLAY_FILE, true);
+            play_sample(af, 0, gain, 0, PLAY_FILE, true);
         }
 
         void sampler_kernel::start_listen_instrument(float velocity, float gain)
@@ -1242,7 +2990,7 @@ namespace lsp
             // Obtain the active file and
             afile_t *af     = select_active_sample(velocity);
             if (af != NULL)
-                play_sample(af, gain, 0, PLAY_INSTRUMENT, true);
+                play_sample(af, 0, gain, 0, PLAY_INSTRUMENT, true);
         }
 
         void sampler_kernel::stop_listen_instrument(bool force)
@@ -1282,7 +3030,7 @@ namespace lsp
             return vActive[f_last];
         }
 
-        void sampler_kernel::trigger_on(size_t timestamp, uint8_t midi_velocity)
+        void sampler_kernel::trigger_on(size_t timestamp, uint8_t midi_velocity, ssize_t key)
         {
             // Get the file and ajdust gain
             float velocity  = float(midi_velocity) / 1.27f;       // Compute velocity in percents
@@ -1291,7 +3039,7 @@ namespace lsp
                 return;
 
             size_t delay    = dspu::millis_to_samples(nSampleRate, af->fPreDelay) + timestamp;
-            lsp_trace("af->id=%d, af->velocity={%.3f .. %.3f}", int(af->nID), af->fMinVelocity, af->fMaxVelocity);
+            lsp_trace("af->id=%d, af->velocity={%.3f .. %.3f}, key=%d", int(af->nID), af->fMinVelocity, af->fMaxVelocity, int(key));
 
             // Apply changes to all ports
             if (af->fMaxVelocity > 0.0f)
@@ -1301,8 +3049,10 @@ namespace lsp
                 const float gain    = (bHandleVelocity) ? (velocity * var) / af->fMaxVelocity : var;
                 delay              += dspu::millis_to_samples(nSampleRate, fDrift) * sRandom.random(dspu::RND_EXP);
 
-                // Play sample
-                play_sample(af, gain, delay, PLAY_NOTE, false);
+                // Play sample, playbacks that do not start in the current block are scheduled
+                // and become voices only when their start time is reached
+                if ((delay < meta::sampler_metadata::BUFFER_SIZE) || (!sEvents.schedule(nTime + delay, af->nID, key, gain)))
+                    start_voice(af, key, gain, delay);
 
                 // Trigger the note On indicator
                 af->sNoteOn.blink();
@@ -1310,22 +3060,27 @@ namespace lsp
             }
         }
 
-        void sampler_kernel::trigger_off(size_t timestamp, bool note_off)
+        void sampler_kernel::trigger_off(size_t timestamp, bool note_off, ssize_t key)
         {
-            lsp_trace("timestamp=%d, note_off=%s",
+            lsp_trace("timestamp=%d, note_off=%s, key=%d",
                 int(timestamp),
-                (note_off) ? "true" : "false");
+                (note_off) ? "true" : "false",
+                int(key));
 
-            // Stop active playback and listen events
+            // Stop active playback and listen events of the key
             for (size_t i=0; i<nFiles; ++i)
             {
                 afile_t *af = &vFiles[i];
                 if ((note_off) || (af->enLoopMode != dspu::SAMPLE_LOOP_NONE))
                 {
+                    dspu::Playback *vpb = key_playback(af, key);
                     for (size_t j=0; j<4; ++j)
-                        af->vPlayback[j].stop(timestamp);
+                        vpb[j].stop(timestamp);
+                    sEvents.stop(nTime + timestamp, af->nID, key);
                 }
             }
+
+            release_voices(note_off, key);
         }
 
         void sampler_kernel::trigger_cancel(size_t timestamp)
@@ -1335,6 +3090,19 @@ namespace lsp
             // Cancel active playback
             for (size_t i=0; i<nFiles; ++i)
                 cancel_sample(&vFiles[i], timestamp);
+            sEvents.cancel(nTime + timestamp);
+
+            for (size_t i=0; i<nVoices; ++i)
+                vVoices[i].bReleased    = true;
+        }
+
+        bool sampler_kernel::submit_task(ipc::ITask *task, size_t cls)
+        {
+            // Tasks are executed by the worker pool of the plugin if it has running threads,
+            // otherwise they are executed by the host
+            if ((pPool != NULL) && (pPool->enabled()))
+                return pPool->submit(task, cls);
+            return pExecutor->submit(task);
         }
 
         void sampler_kernel::process_file_load_requests()
@@ -1356,7 +3124,7 @@ namespace lsp
                 if ((path->pending()) && (af->pLoader->idle()) && (af->pRenderer->idle()))
                 {
                     // Try to submit task
-                    if (pExecutor->submit(af->pLoader))
+                    if (submit_task(af->pLoader, TASK_LOAD))
                     {
                         ++af->nUpdateReq;
                         af->nStatus     = STATUS_LOADING;
@@ -1381,7 +3149,7 @@ namespace lsp
             }
         }
 
-        void sampler_kernel::process_file_render_requests()
+        void sampler_kernel::process_file_render_requests(size_t samples)
         {
             for (size_t i=0; i<nFiles; ++i)
             {
@@ -1390,6 +3158,28 @@ namespace lsp
                 if (af->pFile == NULL)
                     continue;
 
+                // Update render timers
+                af->nRenderSettle   = (af->nRenderSettle > samples) ? af->nRenderSettle - samples : 0;
+                af->nRenderHold     = (af->nRenderHold > samples) ? af->nRenderHold - samples : 0;
+
+                // Bind the playable prefix of the sample while it is being rendered
+                if ((af->pPartial != NULL) && (af->nUpdateReq == af->nUpdateResp))
+                {
+                    dspu::Sample *s     = lsp::atomic_swap(&af->pPartial, NULL);
+                    if (s != NULL)
+                    {
+                        if (!bHotSwap)
+                            cancel_sample(af, 0);
+                        for (size_t j=0; j<nChannels; ++j)
+                            vChannels[j].bind(af->nID, s);
+
+                        // Show the thumbnails of the draft render
+                        const render_params_t *rp = static_cast<render_params_t *>(s->user_data());
+                        if ((rp != NULL) && (rp->bDraft))
+                            af->bDraftSync      = true;
+                    }
+                }
+
                 // Get path and check task state
                 if ((af->nUpdateReq != af->nUpdateResp) && (af->pRenderer->idle()) && (af->pLoader->idle()))
                 {
@@ -1398,37 +3188,57 @@ namespace lsp
                         af->nUpdateResp     = af->nUpdateReq;
                         af->pProcessed      = NULL;
 
-                        // Unbind sample for all channels
+                        // Unbind sample and pitch variants for all channels
                         for (size_t j=0; j<nChannels; ++j)
                             vChannels[j].unbind(af->nID);
+                        bind_variants(af);
 
                         af->bSync           = true;
                     }
-                    else if (pExecutor->submit(af->pRenderer))
+                    else if ((af->nRenderSettle > 0) || (af->nRenderHold > 0))
+                    {
+                        // Wait until parameters settle and the render rate allows to
+                        // start a new render, the latest parameters will be used
+                    }
+                    else if (submit_task(af->pRenderer, (bInteractive) ? TASK_INTERACTIVE : TASK_RENDER))
                     {
                         // Try to submit task
                         af->nUpdateResp     = af->nUpdateReq;
+                        af->nRenderHold     = dspu::millis_to_samples(nSampleRate, fRenderInterval);
                         lsp_trace("successfully submitted renderer task");
                     }
                 }
                 else if (af->pRenderer->completed())
                 {
-                    // Canel all current playbacks for the audio file
-                    cancel_sample(af, 0);
+                    // Canel all current playbacks for the audio file. In hot-swap mode the sample player
+                    // keeps the previous sample alive until the last playback that uses it ends,
+                    // new playbacks will use the new sample.
+                    if (!bHotSwap)
+                        cancel_sample(af, 0);
 
                     // Commit changes if there is no more pending tasks
                     if (af->nUpdateReq == af->nUpdateResp)
                     {
                         // Bind sample for all channels
+                        dspu::Sample *s     = af->pProcessed;
                         for (size_t j=0; j<nChannels; ++j)
-                            vChannels[j].bind(af->nID, af->pProcessed);
+                            vChannels[j].bind(af->nID, s);
+                        bind_variants(af);
 
-                        // The sample is now under the garbage control inside of the sample player
+                        // The sample is now under the garbage control inside of the sample player,
+                        // drop the reference held by the renderer for the shared sample. If it was
+                        // the last reference, the sample is passed to the garbage collector
                         af->pProcessed      = NULL;
+                        if ((s != NULL) && (is_shared_sample(s)) && (s->gc_release() == 0))
+                        {
+                            s->gc_link(pGCReleased);
+                            pGCReleased         = s;
+                        }
                     }
 
                     af->pRenderer->reset();
                     af->bSync           = true;
+                    af->bDraftSync      = false;
                 }
             }
         }
@@ -1440,16 +3250,34 @@ namespace lsp
 
             if (sGCTask.idle())
             {
-                // Obtain the list of samples for destroy
-                if (pGCList == NULL)
+                // Pass the shared samples released by the audio thread to the garbage collector
+                if (pGCReleased != NULL)
+                {
+                    dspu::Sample *tail  = pGCReleased;
+                    while (tail->gc_next() != NULL)
+                        tail                = tail->gc_next();
+                    tail->gc_link(pGCList);
+                    pGCList             = pGCReleased;
+                    pGCReleased         = NULL;
+                }
+
+                // Collect the lists of samples for destroy from all channels and
+                // prepend them to the list of pending samples
+                for (size_t i=0; i<nChannels; ++i)
                 {
-                    for (size_t i=0; i<meta::sampler_metadata::TRACKS_MAX; ++i)
-                        if ((pGCList = vChannels[i].gc()) != NULL)
-                            break;
+                    dspu::Sample *head  = vChannels[i].gc();
+                    if (head == NULL)
+                        continue;
+
+                    dspu::Sample *tail  = head;
+                    while (tail->gc_next() != NULL)
+                        tail                = tail->gc_next();
+                    tail->gc_link(pGCList);
+                    pGCList             = head;
                 }
 
                 if (pGCList != NULL)
-                    pExecutor->submit(&sGCTask);
+                    submit_task(&sGCTask, TASK_GC);
             }
         }
 
@@ -1589,13 +3417,20 @@ namespace lsp
 
                 // Store file thumbnails to mesh
                 plug::mesh_t *mesh  = reinterpret_cast<plug::mesh_t *>(af->pMesh->buffer());
-                if ((mesh == NULL) || (!mesh->isEmpty()) || (!af->bSync) || (!af->pLoader->idle()) || (!af->pRenderer->idle()))
+                if ((mesh == NULL) || (!mesh->isEmpty()) || (!af->pLoader->idle()))
+                    continue;
+
+                // Thumbnails of the draft render are shown while the full render is in progress
+                const bool draft    = (af->bDraftSync) && (!af->pRenderer->idle());
+                if ((!draft) && ((!af->bSync) || (!af->pRenderer->idle())))
                     continue;
 
                 if ((channels > 0) && (af->vThumbs[0] != NULL))
                 {
                     // Copy thumbnails
-                    const float * const *thumbs = (af->bEnvEdit) ? af->vCutThumbs : af->vThumbs;
+                    const float * const *thumbs = (draft) ?
+                        ((af->bEnvEdit) ? af->vDraftCutThumbs : af->vDraftThumbs) :
+                        ((af->bEnvEdit) ? af->vCutThumbs : af->vThumbs);
                     for (size_t j=0; j<channels; ++j)
                         dsp::copy(mesh->pvData[j], thumbs[j], meta::sampler_metadata::MESH_SIZE);
 
@@ -1604,19 +3439,57 @@ namespace lsp
                 else
                     mesh->data(0, 0);
 
-                af->bSync           = false;
+                if (draft)
+                    af->bDraftSync      = false;
+                else
+                    af->bSync           = false;
             }
         }
 
         void sampler_kernel::process(float **listens, float **outs, const float **ins, size_t samples)
         {
             process_file_load_requests();
-            process_file_render_requests();
+            process_file_render_requests(samples);
             process_gc_tasks();
             reorder_samples();
             process_listen_events();
+            process_finished_voices();
+            process_scheduled_events(samples);
             play_samples(listens, outs, ins, samples);
             output_parameters(samples);
+
+            nTime          += samples;
+        }
+
+        void sampler_kernel::process_scheduled_events(size_t samples)
+        {
+            const size_t fadeout    = dspu::millis_to_samples(nSampleRate, fFadeout);
+            trigger_event_t ev;
+
+            // Turn the events that start in the current block into playbacks
+            while (sEvents.fetch(&ev, nTime, nTime + samples))
+            {
+                afile_t *af         = &vFiles[ev.nFile];
+                const wsize_t start = lsp_max(ev.nStart, nTime);
+                if (!start_voice(af, ev.nKey, ev.fGain, start - nTime))
+                    continue;
+
+                // Apply the note off and the cancel that happened while the event was waiting,
+                // the playback handles belong to earlier notes if the voice has not been started
+                dspu::Playback *vpb = key_playback(af, ev.nKey);
+                if (ev.nStop != event_wheel::EVENT_NEVER)
+                {
+                    const size_t delay  = lsp_max(ev.nStop, start) - nTime;
+                    for (size_t j=0; j<4; ++j)
+                        vpb[j].stop(delay);
+                }
+                if (ev.nCancel != event_wheel::EVENT_NEVER)
+                {
+                    const size_t delay  = lsp_max(ev.nCancel, start) - nTime;
+                    for (size_t j=0; j<4; ++j)
+                        vpb[j].cancel(fadeout, delay);
+                }
+            }
         }
 
         float sampler_kernel::compute_play_position(const afile_t *f)
@@ -1646,6 +3519,33 @@ namespace lsp
             return time;
         }
 
+        void sampler_kernel::dump_render_stage(dspu::IStateDumper *v, const char *name, const render_stage_t *s)
+        {
+            v->begin_object(name, s, sizeof(render_stage_t));
+            {
+                v->write("nHash", s->nHash);
+                v->write_object("pSample", s->pSample);
+                v->begin_object("sParams", &s->sParams, sizeof(render_params_t));
+                {
+                    v->write("nLength", s->sParams.nLength);
+                    v->write("nHeadCut", s->sParams.nHeadCut);
+                    v->write("nTailCut", s->sParams.nTailCut);
+                    v->write("nCutLength", s->sParams.nCutLength);
+                    v->write("nStretchDelta", s->sParams.nStretchDelta);
+                    v->write("nStretchStart", s->sParams.nStretchStart);
+                    v->write("nStretchEnd", s->sParams.nStretchEnd);
+                    v->write("nLoopStart", s->sParams.nLoopStart);
+                    v->write("nLoopEnd", s->sParams.nLoopEnd);
+                    v->write("nLoopFade", s->sParams.nLoopFade);
+                    v->write("bShared", s->sParams.bShared);
+                    v->write("bReversed", s->sParams.bReversed);
+                    v->write("bDraft", s->sParams.bDraft);
+                }
+                v->end_object();
+            }
+            v->end_object();
+        }
+
         void sampler_kernel::dump_afile(dspu::IStateDumper *v, const afile_t *f) const
         {
             v->write("nID", f->nID);
@@ -1656,13 +3556,24 @@ namespace lsp
             v->write_object("sNoteOn", &f->sNoteOn);
             v->write_object_array("vPlayback", f->vPlayback, 4);
             v->write_object_array("vListen", f->vListen, 4);
+            v->write("vKeyPlayback", f->vKeyPlayback);
             v->write_object("pOriginal", f->pOriginal);
             v->write_object("pProcessed", f->pProcessed);
+            v->write_object("pPartial", f->pPartial);
+            v->write("vVariants", f->vVariants);
             v->write("vThumbs", f->vThumbs);
+            v->write("vDraftThumbs", f->vDraftThumbs);
+            v->write("vDraftCutThumbs", f->vDraftCutThumbs);
+            dump_render_stage(v, "sSourceStage", &f->sSourceStage);
+            dump_render_stage(v, "sStretchStage", &f->sStretchStage);
+            dump_render_stage(v, "sCutStage", &f->sCutStage);
 
             v->write("nUpdateReq", f->nUpdateReq);
             v->write("nUpdateResp", f->nUpdateResp);
+            v->write("nRenderSettle", f->nRenderSettle);
+            v->write("nRenderHold", f->nRenderHold);
             v->write("bSync", f->bSync);
+            v->write("bDraftSync", f->bDraftSync);
             v->write("fMinVelocity", f->fMinVelocity);
             v->write("fMaxVelocity", f->fMaxVelocity);
             v->write("fPitch", f->fPitch);
@@ -1674,6 +3585,7 @@ namespace lsp
             v->write("fStretchChunk", f->fStretchChunk);
             v->write("fStretchFade", f->fStretchFade);
             v->write("nStretchFadeType", f->nStretchFadeType);
+            v->write("fStretchRate", f->fStretchRate);
 
             v->write("enLoopMode", int(f->enLoopMode));
             v->write("fLoopStart", f->fLoopStart);
@@ -1782,7 +3694,35 @@ namespace lsp
         void sampler_kernel::dump(dspu::IStateDumper *v) const
         {
             v->write("pExecutor", pExecutor);
-            v->write("pGCList", pExecutor);
+            v->write("pPool", pPool);
+            v->write("pGCList", pGCList);
+            v->write("pGCReleased", pGCReleased);
+            v->write("nGCReclaimed", nGCReclaimed);
+            v->write_object("sEvents", &sEvents);
+            v->write("nTime", nTime);
+            v->begin_array("vVoices", vVoices, nVoices);
+            {
+                for (size_t i=0; i<nVoices; ++i)
+                {
+                    const voice_t *vc = &vVoices[i];
+                    v->begin_object(vc, sizeof(voice_t));
+                    {
+                        v->write("nStart", vc->nStart);
+                        v->write("nFile", vc->nFile);
+                        v->write("nKey", vc->nKey);
+                        v->write("fGain", vc->fGain);
+                        v->write("bReleased", vc->bReleased);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("nVoices", nVoices);
+            v->write("nPolyphony", nPolyphony);
+            v->write("nStealPolicy", nStealPolicy);
+            v->write("nKeyRange", nKeyRange);
+            v->write("bTrackVoices", bTrackVoices);
+            v->write("nLastVoice", nLastVoice);
             v->begin_array("vFiles", vFiles, nFiles);
             {
                 for (size_t i=0; i<nFiles; ++i)
@@ -1813,6 +3753,14 @@ namespace lsp
             v->write("bReorder", bReorder);
             v->write("bHandleVelocity", bHandleVelocity);
             v->write("fFadeout", fFadeout);
+            v->write("fRenderSettle", fRenderSettle);
+            v->write("fRenderInterval", fRenderInterval);
+            v->write("nResampleQuality", nResampleQuality);
+            v->write("nStretchEngine", nStretchEngine);
+            v->write("bLoopBake", bLoopBake);
+            v->write("bHotSwap", bHotSwap);
+            v->write("bInteractive", bInteractive);
+            v->write_object("sScratch", &sScratch);
             v->write("fDynamics", fDynamics);
             v->write("fDrift", fDrift);
             v->write("nSampleRate", nSampleRate);
@@ -1820,6 +3768,9 @@ namespace lsp
             v->write("pDynamics", pDynamics);
             v->write("pHandleVelocity", pHandleVelocity);
             v->write("pDrift", pDrift);
+            v->write("pPolyphony", pPolyphony);
+            v->write("pStealPolicy", pStealPolicy);
+            v->write("pKeyRange", pKeyRange);
             v->write("pSampleSel", pSampleSel);
             v->write("pActivity", pActivity);
             v->write("pListen", pListen);
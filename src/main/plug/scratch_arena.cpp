@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+
+#include <private/plugins/scratch_arena.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        scratch_arena::scratch_arena()
+        {
+            pBlock          = NULL;
+            pData           = NULL;
+            nCapacity       = 0;
+            nUsed           = 0;
+            nRequested      = 0;
+            nUsers          = 0;
+        }
+
+        scratch_arena::~scratch_arena()
+        {
+            destroy();
+        }
+
+        void scratch_arena::destroy()
+        {
+            release();
+            vOverflow.flush();
+
+            free_aligned(pBlock);
+            pData           = NULL;
+            nCapacity       = 0;
+        }
+
+        void scratch_arena::release()
+        {
+            for (size_t i=0, n=vOverflow.size(); i<n; ++i)
+            {
+                uint8_t *ptr    = vOverflow.uget(i);
+                free_aligned(ptr);
+            }
+            vOverflow.clear();
+
+            nUsed           = 0;
+            nRequested      = 0;
+        }
+
+        void scratch_arena::begin()
+        {
+            sLock.lock();
+            lsp_finally { sLock.unlock(); };
+
+            ++nUsers;
+        }
+
+        void scratch_arena::end()
+        {
+            sLock.lock();
+            lsp_finally { sLock.unlock(); };
+
+            if ((--nUsers) > 0)
+                return;
+
+            // Grow the memory block to the high-water mark
+            const size_t requested  = nRequested;
+            release();
+            if (requested <= nCapacity)
+                return;
+
+            free_aligned(pBlock);
+            nCapacity       = 0;
+            pData           = alloc_aligned<uint8_t>(pBlock, requested);
+            if (pData != NULL)
+                nCapacity       = requested;
+            lsp_trace("Scratch arena grown to %ld bytes", long(nCapacity));
+        }
+
+        float *scratch_arena::alloc(size_t count)
+        {
+            const size_t bytes      = align_size(count * sizeof(float), DEFAULT_ALIGN);
+
+            sLock.lock();
+            lsp_finally { sLock.unlock(); };
+
+            nRequested         += bytes;
+
+            // Allocate buffer from the memory block
+            if (nUsed + bytes <= nCapacity)
+            {
+                float *ptr              = reinterpret_cast<float *>(&pData[nUsed]);
+                nUsed                  += bytes;
+                return ptr;
+            }
+
+            // The memory block is exhausted, allocate buffer on the heap
+            uint8_t *data           = NULL;
+            float *ptr              = alloc_aligned<float>(data, count);
+            if (ptr == NULL)
+                return NULL;
+            if (!vOverflow.add(data))
+            {
+                free_aligned(data);
+                return NULL;
+            }
+
+            return ptr;
+        }
+
+        void scratch_arena::dump(dspu::IStateDumper *v) const
+        {
+            v->write("pBlock", pBlock);
+            v->write("pData", pData);
+            v->write("nCapacity", nCapacity);
+            v->write("nUsed", nUsed);
+            v->write("nRequested", nRequested);
+            v->write("nUsers", nUsers);
+            v->write("nOverflow", vOverflow.size());
+        }
+
+    } /* namespace plugins */
+} /* namespace lsp */
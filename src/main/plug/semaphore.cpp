@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <limits.h>
+
+#include <private/plugins/semaphore.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+    #if defined(PLATFORM_WINDOWS)
+        semaphore::semaphore()
+        {
+            hSem        = CreateSemaphoreW(NULL, 0, LONG_MAX, NULL);
+        }
+
+        semaphore::~semaphore()
+        {
+            CloseHandle(hSem);
+        }
+
+        void semaphore::post()
+        {
+            ReleaseSemaphore(hSem, 1, NULL);
+        }
+
+        void semaphore::wait()
+        {
+            WaitForSingleObject(hSem, INFINITE);
+        }
+    #elif defined(PLATFORM_MACOSX)
+        semaphore::semaphore()
+        {
+            hSem        = dispatch_semaphore_create(0);
+        }
+
+        semaphore::~semaphore()
+        {
+            dispatch_release(hSem);
+        }
+
+        void semaphore::post()
+        {
+            dispatch_semaphore_signal(hSem);
+        }
+
+        void semaphore::wait()
+        {
+            dispatch_semaphore_wait(hSem, DISPATCH_TIME_FOREVER);
+        }
+    #else
+        semaphore::semaphore()
+        {
+            sem_init(&hSem, 0, 0);
+        }
+
+        semaphore::~semaphore()
+        {
+            sem_destroy(&hSem);
+        }
+
+        void semaphore::post()
+        {
+            sem_post(&hSem);
+        }
+
+        void semaphore::wait()
+        {
+            // Restart the wait if it has been interrupted by the signal
+            while ((sem_wait(&hSem) != 0) && (errno == EINTR))
+                /* nothing */;
+        }
+    #endif /* PLATFORM_WINDOWS */
+
+    } /* namespace plugins */
+} /* namespace lsp */
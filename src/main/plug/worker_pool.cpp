@@ -0,0 +1,497 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-sampler
+ * Created on: 18 окт. 2026 г.
+ *
+ * lsp-plugins-sampler is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-sampler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-sampler. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/debug.h>
+
+#include <private/plugins/worker_pool.h>
+
+namespace lsp
+{
+    namespace plugins
+    {
+        namespace
+        {
+            // Interval between checks of the resize task state on shutdown (ms)
+            static constexpr size_t DESTROY_WAIT        = 1;
+            // Maximum time to wait for the pending resize task on shutdown (ms)
+            static constexpr size_t RESIZE_TIMEOUT      = 1000;
+        } /* namespace */
+
+        //-------------------------------------------------------------------------
+        worker_pool::Worker::Worker(worker_pool *pool)
+        {
+            pPool       = pool;
+            bExited     = false;
+        }
+
+        worker_pool::Worker::~Worker()
+        {
+            pPool       = NULL;
+        }
+
+        status_t worker_pool::Worker::run()
+        {
+            return pPool->execute(this);
+        }
+
+        //-------------------------------------------------------------------------
+        worker_pool::Resizer::Resizer(worker_pool *pool)
+        {
+            pPool       = pool;
+        }
+
+        worker_pool::Resizer::~Resizer()
+        {
+            pPool       = NULL;
+        }
+
+        status_t worker_pool::Resizer::run()
+        {
+            pPool->resize();
+            return STATUS_OK;
+        }
+
+        //-------------------------------------------------------------------------
+        worker_pool::worker_pool():
+            sResizer(this)
+        {
+            for (size_t i=0; i<TASK_CLASSES; ++i)
+            {
+                queue_t *q      = &vQueues[i];
+                q->vTasks       = NULL;
+                q->nHead        = 0;
+                q->nSize        = 0;
+            }
+            for (size_t i=0; i<meta::sampler_metadata::WORKERS_MAX; ++i)
+                vWorkers[i]     = NULL;
+
+            nCapacity       = 0;
+            nThreads        = 0;
+            nRequired       = 0;
+            nApplied        = 0;
+            nBackground     = 0;
+            nStop           = 0;
+            bShutdown       = false;
+            pData           = NULL;
+        }
+
+        worker_pool::~worker_pool()
+        {
+            destroy();
+        }
+
+        bool worker_pool::init(size_t capacity)
+        {
+            entry_t *ptr        = static_cast<entry_t *>(malloc(sizeof(entry_t) * capacity * TASK_CLASSES));
+            if (ptr == NULL)
+                return false;
+
+            pData           = ptr;
+            nCapacity       = capacity;
+            bShutdown       = false;
+            for (size_t i=0; i<TASK_CLASSES; ++i)
+            {
+                queue_t *q      = &vQueues[i];
+                q->vTasks       = advance_ptr<entry_t>(ptr, capacity);
+                q->nHead        = 0;
+                q->nSize        = 0;
+            }
+
+            return true;
+        }
+
+        void worker_pool::destroy()
+        {
+            wait_resize();
+
+            sResize.lock();
+            lsp_finally { sResize.unlock(); };
+
+            bShutdown       = true;
+            nRequired       = 0;
+            nApplied        = 0;
+            stop_threads(0);
+
+            // The queued tasks are dropped and become idle, so their owners can submit
+            // them again or destroy them
+            for (size_t i=0; i<TASK_CLASSES; ++i)
+            {
+                queue_t *q      = &vQueues[i];
+                for (size_t j=0; j<q->nSize; ++j)
+                    change_task_state(q->vTasks[(q->nHead + j) % nCapacity].pTask, ipc::ITask::TS_IDLE);
+
+                q->vTasks       = NULL;
+                q->nHead        = 0;
+                q->nSize        = 0;
+            }
+
+            if (pData != NULL)
+            {
+                free(pData);
+                pData           = NULL;
+            }
+            nCapacity       = 0;
+        }
+
+        void worker_pool::set_threads(size_t threads)
+        {
+            nRequired       = lsp_min(threads, meta::sampler_metadata::WORKERS_MAX);
+        }
+
+        ipc::ITask *worker_pool::resize_task()
+        {
+            if (sResizer.completed())
+                sResizer.reset();
+            if ((bShutdown) || (!sResizer.idle()) || (nApplied == nRequired))
+                return NULL;
+
+            return &sResizer;
+        }
+
+        bool worker_pool::enabled() const
+        {
+            return atomic_load(&nThreads) > 0;
+        }
+
+        bool worker_pool::submit(ipc::ITask *task, size_t cls)
+        {
+            if ((task == NULL) || (!task->idle()) || (cls >= TASK_CLASSES))
+                return false;
+
+            // Do not block the caller, the task will be submitted on the next attempt
+            if (!sLock.try_lock())
+                return false;
+
+            const bool queued   = push(task, cls, NULL);
+            sLock.unlock();
+
+            // Wake up the idle worker
+            if (queued)
+                sWork.post();
+
+            return queued;
+        }
+
+        bool worker_pool::submit(ipc::ITask *task)
+        {
+            return submit(task, TASK_RENDER);
+        }
+
+        void worker_pool::execute_group(ipc::ITask * const *tasks, size_t count, size_t cls)
+        {
+            if ((count <= 0) || (cls >= TASK_CLASSES))
+                return;
+
+            // Offer all tasks except the first one to the worker threads
+            semaphore done;
+            sLock.lock();
+            size_t queued       = 0;
+            for (size_t i=1; i<count; ++i)
+            {
+                if (push(tasks[i], cls, &done))
+                    ++queued;
+            }
+            sLock.unlock();
+            for (size_t i=0; i<queued; ++i)
+                sWork.post();
+
+            // Execute the first task and the tasks not taken by the workers
+            size_t pending      = 0;
+            run_task(tasks[0]);
+            for (size_t i=1; i<count; ++i)
+            {
+                ipc::ITask *task    = tasks[i];
+                if ((task->idle()) || (revoke(task, cls)))
+                    run_task(task);
+                else
+                    ++pending;
+            }
+
+            // Wait for the tasks executed by the workers
+            for ( ; pending > 0; --pending)
+                done.wait();
+        }
+
+        void worker_pool::shutdown()
+        {
+            wait_resize();
+
+            sResize.lock();
+            lsp_finally { sResize.unlock(); };
+
+            bShutdown       = true;
+            nRequired       = 0;
+            apply_threads(0);
+        }
+
+        void worker_pool::wait_resize()
+        {
+            // The resize task may still be queued or executed by the host executor. Do not hang
+            // if the executor never runs it, the shutdown flag cancels the task in this case
+            for (size_t waited=0; (!sResizer.idle()) && (!sResizer.completed()); waited += DESTROY_WAIT)
+            {
+                if (waited >= RESIZE_TIMEOUT)
+                {
+                    lsp_warn("Resize task of the worker pool has not been executed in time, cancelling it");
+                    break;
+                }
+                ipc::Thread::sleep(DESTROY_WAIT);
+            }
+        }
+
+        bool worker_pool::push(ipc::ITask *task, size_t cls, semaphore *done)
+        {
+            queue_t *q          = &vQueues[cls];
+            if ((nThreads <= 0) || (q->nSize >= nCapacity))
+                return false;
+
+            change_task_state(task, ipc::ITask::TS_SUBMITTED);
+            entry_t *e          = &q->vTasks[(q->nHead + q->nSize) % nCapacity];
+            e->pTask            = task;
+            e->pDone            = done;
+            ++q->nSize;
+
+            return true;
+        }
+
+        bool worker_pool::revoke(ipc::ITask *task, size_t cls)
+        {
+            sLock.lock();
+            lsp_finally { sLock.unlock(); };
+
+            queue_t *q          = &vQueues[cls];
+            for (size_t i=0; i<q->nSize; ++i)
+            {
+                if (q->vTasks[(q->nHead + i) % nCapacity].pTask != task)
+                    continue;
+
+                // Shift the rest of the queue to keep the order of tasks
+                for (size_t j=i+1; j<q->nSize; ++j)
+                    q->vTasks[(q->nHead + j - 1) % nCapacity] = q->vTasks[(q->nHead + j) % nCapacity];
+                --q->nSize;
+                return true;
+            }
+
+            return false;
+        }
+
+        ipc::ITask *worker_pool::fetch(size_t *cls, semaphore **done)
+        {
+            sLock.lock();
+            lsp_finally { sLock.unlock(); };
+
+            // Background tasks never occupy all threads if the pool has more than one thread
+            const size_t background = (nThreads > 1) ? nThreads - 1 : 1;
+
+            for (size_t i=0; i<TASK_CLASSES; ++i)
+            {
+                queue_t *q          = &vQueues[i];
+                if (q->nSize <= 0)
+                    continue;
+                if ((i >= TASK_RENDER) && (nBackground >= background))
+                    return NULL;
+
+                const entry_t *e    = &q->vTasks[q->nHead];
+                ipc::ITask *task    = e->pTask;
+                *done               = e->pDone;
+                q->nHead            = (q->nHead + 1) % nCapacity;
+                --q->nSize;
+                if (i >= TASK_RENDER)
+                    ++nBackground;
+
+                *cls                = i;
+                return task;
+            }
+
+            return NULL;
+        }
+
+        void worker_pool::complete(size_t cls)
+        {
+            if (cls < TASK_RENDER)
+                return;
+
+            sLock.lock();
+            lsp_finally { sLock.unlock(); };
+            --nBackground;
+        }
+
+        status_t worker_pool::execute(Worker *w)
+        {
+            while (true)
+            {
+                // Wait for the submitted task or for the stop request
+                sWork.wait();
+
+                sLock.lock();
+                if (nStop > 0)
+                {
+                    --nStop;
+                    w->set_exited();
+                    sLock.unlock();
+                    sExit.post();
+                    return STATUS_OK;
+                }
+                sLock.unlock();
+
+                // Execute all available tasks, the extra posts of the semaphore just
+                // wake up the worker once more
+                size_t cls          = 0;
+                semaphore *done     = NULL;
+                for (ipc::ITask *task = fetch(&cls, &done); task != NULL; task = fetch(&cls, &done))
+                {
+                    run_task(task);
+                    complete(cls);
+                    if (done != NULL)
+                        done->post();
+                }
+            }
+        }
+
+        void worker_pool::stop_threads(size_t count)
+        {
+            if (nThreads <= count)
+                return;
+
+            // Any idle worker may handle the stop request, the busy ones complete
+            // their current tasks first
+            const size_t stop   = nThreads - count;
+            sLock.lock();
+            nStop              += stop;
+            sLock.unlock();
+
+            for (size_t i=0; i<stop; ++i)
+                sWork.post();
+            for (size_t i=0; i<stop; ++i)
+                sExit.wait();
+
+            // Remove exited threads from the list
+            Worker *exited[meta::sampler_metadata::WORKERS_MAX];
+            size_t n_exited     = 0;
+
+            sLock.lock();
+            size_t n_threads    = 0;
+            for (size_t i=0; i<nThreads; ++i)
+            {
+                Worker *w           = vWorkers[i];
+                vWorkers[i]         = NULL;
+                if (w->exited())
+                    exited[n_exited++]  = w;
+                else
+                    vWorkers[n_threads++]   = w;
+            }
+            atomic_store(&nThreads, uatomic_t(n_threads));
+            sLock.unlock();
+
+            for (size_t i=0; i<n_exited; ++i)
+            {
+                exited[i]->join();
+                delete exited[i];
+            }
+        }
+
+        void worker_pool::drain()
+        {
+            // Execute the tasks left in the queues when the last thread has been stopped
+            while (true)
+            {
+                size_t cls          = 0;
+                semaphore *done     = NULL;
+                ipc::ITask *task    = fetch(&cls, &done);
+                if (task == NULL)
+                    break;
+
+                run_task(task);
+                complete(cls);
+                if (done != NULL)
+                    done->post();
+            }
+        }
+
+        void worker_pool::resize()
+        {
+            // Only one thread starts and stops the worker threads
+            sResize.lock();
+            lsp_finally { sResize.unlock(); };
+
+            if (bShutdown)
+                return;
+            apply_threads(nRequired);
+        }
+
+        void worker_pool::apply_threads(size_t required)
+        {
+            stop_threads(required);
+            if (nThreads <= 0)
+                drain();
+
+            while (nThreads < required)
+            {
+                Worker *w           = new Worker(this);
+                if (w == NULL)
+                    break;
+                if (w->start() != STATUS_OK)
+                {
+                    delete w;
+                    break;
+                }
+
+                sLock.lock();
+                vWorkers[nThreads]      = w;
+                atomic_store(&nThreads, uatomic_t(nThreads + 1));
+                sLock.unlock();
+            }
+
+            nApplied                = required;
+            lsp_trace("Worker pool resized to %d threads", int(nThreads));
+        }
+
+        void worker_pool::dump(dspu::IStateDumper *v) const
+        {
+            v->begin_array("vQueues", vQueues, TASK_CLASSES);
+            {
+                for (size_t i=0; i<TASK_CLASSES; ++i)
+                {
+                    const queue_t *q = &vQueues[i];
+                    v->begin_object(q, sizeof(queue_t));
+                    {
+                        v->write("vTasks", q->vTasks);
+                        v->write("nHead", q->nHead);
+                        v->write("nSize", q->nSize);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("nCapacity", nCapacity);
+            v->write("nThreads", size_t(nThreads));
+            v->write("nRequired", nRequired);
+            v->write("nApplied", nApplied);
+            v->write("nBackground", nBackground);
+            v->write("nStop", nStop);
+            v->write("bShutdown", bShutdown);
+            v->write("pData", pData);
+        }
+
+    } /* namespace plugins */
+} /* namespace lsp */